@@ -3,6 +3,8 @@
 
 #include <functional>
 #include <map>
+#include <string>
+#include <vector>
 #include <mex.h>
 #include <matrix.h>
 
@@ -11,49 +13,78 @@ typedef void mxFunc(int, mxArray*[], int, const mxArray*[]);
 struct func_data {
     std::function<mxFunc> f;
     int out, in_min, in_max;
-    func_data() : f(), out(0), in_min(0), in_max(0) {};
+    // filled in by Factory::record
+    uint32_t id;
+    std::string name;
+    func_data() : f(), out(0), in_min(0), in_max(0), id(0), name() {};
     func_data(std::function<mxFunc> function, int out_args, int in_args) : func_data(function, out_args, in_args, in_args) {}
-    func_data(std::function<mxFunc> function, int out_args, int in_min_args, int in_max_args) : f(function), out(out_args), in_min(in_min_args), in_max(in_max_args) {}
+    func_data(std::function<mxFunc> function, int out_args, int in_min_args, int in_max_args) : f(function), out(out_args), in_min(in_min_args), in_max(in_max_args), id(0), name() {}
 };
 
 class ClassFactory
 {
+    friend class Factory;
 private:
     std::string name;
     std::map<std::string, func_data> funcs;
 public:
-    ClassFactory(std::string n) : name(n), funcs() {}
-    void record(std::string fname, int out, int in, std::function<mxFunc> func)
+    ClassFactory(const std::string& n) : name(n), funcs() {}
+    void record(const std::string& fname, int out, int in, std::function<mxFunc> func)
     {
         funcs.emplace(fname, func_data(func, out, in));
     }
-    void record(std::string fname, int out, int in_min, int in_max, std::function<mxFunc> func)
+    void record(const std::string& fname, int out, int in_min, int in_max, std::function<mxFunc> func)
     {
         funcs.emplace(fname, func_data(func, out, in_min, in_max));
     }
 
-    std::string get_name() { return name; }
+    const std::string& get_name() const { return name; }
 
-    func_data get(std::string f){
+    const func_data* get(const std::string& f) const {
         auto func = funcs.find(f);
-        if (func == funcs.end()) return func_data();
-        return func->second;
+        if (func == funcs.end()) return nullptr;
+        return &func->second;
     }
+    const std::map<std::string, func_data>& get_funcs() const { return funcs; }
 };
 
+// Functions are looked up either by class and function name, or by the integer id assigned to
+// them when their class is recorded. The .m files fetch the ids of their class once (see
+// "librealsense_mex::method_ids") and pass them instead of the two strings, which saves
+// converting the strings and the two map lookups on every call.
 class Factory
 {
 private:
     std::map<std::string, ClassFactory> classes;
+    // ids index into this table. Points into the maps above, whose nodes never move
+    std::vector<const func_data*> by_id;
 public:
-    Factory() = default;
-    void record(ClassFactory cls) { classes.emplace(cls.get_name(), cls); }
+    Factory() : classes(), by_id(1, nullptr) {} // id 0 is never valid
+    void record(ClassFactory cls) {
+        auto res = classes.emplace(cls.get_name(), std::move(cls));
+        if (!res.second) return;
+        auto& added = res.first->second;
+        for (auto& func : added.funcs) {
+            func.second.id = static_cast<uint32_t>(by_id.size());
+            func.second.name = added.get_name() + "::" + func.first.substr(0, func.first.find("#", 0));
+            by_id.push_back(&func.second);
+        }
+    }
 
-    func_data get(std::string c, std::string f){
+    const func_data* get(const std::string& c, const std::string& f) const {
         auto cls = classes.find(c);
-        if (cls == classes.end()) return func_data();
+        if (cls == classes.end()) return nullptr;
         return cls->second.get(f);
     }
+    const func_data* get(uint32_t id) const {
+        if (id >= by_id.size()) return nullptr;
+        return by_id[id];
+    }
+    const ClassFactory* get_class(const std::string& c) const {
+        auto cls = classes.find(c);
+        if (cls == classes.end()) return nullptr;
+        return &cls->second;
+    }
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -6,6 +6,7 @@
 #include <vector>
 #include <array>
 #include <type_traits>
+#include "convert.h"
 
 template <typename T> using is_basic_type = std::bool_constant<std::is_arithmetic<T>::value || std::is_pointer<T>::value || std::is_enum<T>::value>;
 template <typename T> struct is_array_type : std::false_type {};
@@ -154,12 +155,27 @@ private:
             from_internal(typename internal_t<T>* ptr) { return T(*ptr); }
         template <typename T> using use_cells = std::integral_constant<bool, detector<T>::use_cells>;
     };
+    // std::vector<bool> has no data() to copy into, so bools are pushed one by one
+    template <typename T, typename U> static std::vector<T> parse_basic_array(const U* ptr, size_t length, std::false_type)
+    {
+        std::vector<T> ret(length);
+        convert::copy_elements(ret.data(), ptr, length);
+        return ret;
+    }
+    template <typename T, typename U> static std::vector<T> parse_basic_array(const U* ptr, size_t length, std::true_type)
+    {
+        std::vector<T> ret;
+        ret.reserve(length);
+        for (size_t i = 0; i < length; ++i) ret.push_back(ptr[i] != 0);
+        return ret;
+    }
 public:
     MatlabParamParser() {};
     ~MatlabParamParser() {};
 
     // TODO: try/catch->err msg?
-    template <typename T> static T parse(const mxArray* cell) { return mx_wrapper_fns<T>::parse(cell); }
+    // usually returns a T, some types (eg rs2::frame) are parsed as a reference to the object held for matlab
+    template <typename T> static auto parse(const mxArray* cell) -> decltype(mx_wrapper_fns<T>::parse(cell)) { return mx_wrapper_fns<T>::parse(cell); }
     template <typename T> static mxArray* wrap(T&& var) { return mx_wrapper_fns<T>::wrap(std::move(var)); };
     template <typename T> static void destroy(const mxArray* cell) { return mx_wrapper_fns<T>::destroy(cell); }
 
@@ -253,6 +269,13 @@ template<> static mxArray* MatlabParamParser::mx_wrapper_fns<const char *>::wrap
     return mxCreateString(str);
 }
 
+// bools are sent by the .m files as logicals, which are a single byte. Reading them as any other
+// integer would read past the value, so take whatever numeric or logical scalar was passed
+template<> static bool MatlabParamParser::mx_wrapper_fns<bool>::parse(const mxArray* cell)
+{
+    return mxGetScalar(cell) != 0;
+}
+
 template<> static std::string MatlabParamParser::mx_wrapper_fns<std::string>::parse(const mxArray* cell)
 {
     auto str = mxArrayToString(cell);
@@ -299,14 +322,9 @@ template <typename T> static typename std::enable_if<is_basic_type<T>::value, st
 {
     using wrapper_t = mx_wrapper<T>;
 
-    std::vector<T> ret;
     auto length = mxGetNumberOfElements(cells);
-    ret.reserve(length);
-    auto ptr = static_cast<typename wrapper_t::type*>(mxGetData(cells)); // array of uint64_t's
-    for (int i = 0; i < length; ++i) {
-        ret.push_back(ptr[i]);
-    }
-    return ret;
+    auto ptr = static_cast<typename wrapper_t::type*>(mxGetData(cells));
+    return parse_basic_array<T>(ptr, length, std::is_same<T, bool>());
 }
 template <typename T> static typename std::enable_if<!is_basic_type<T>::value && !MatlabParamParser::traits_trampoline::use_cells<T>::value, mxArray*>::type
 MatlabParamParser::wrap_array(const T* var, size_t length)
@@ -333,8 +351,7 @@ template <typename T> static typename std::enable_if<is_basic_type<T>::value, mx
 {
     auto cells = mxCreateNumericMatrix(1, length, MatlabParamParser::mx_wrapper<T>::value::value, mxREAL);
     auto ptr = static_cast<typename mx_wrapper<T>::type*>(mxGetData(cells));
-    for (int x = 0; x < length; ++x)
-        ptr[x] = mx_wrapper<T>::type(var[x]);
+    convert::copy_elements(ptr, var, length);
 
     return cells;
 }
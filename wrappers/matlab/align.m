@@ -3,6 +3,9 @@ classdef align < handle
     properties (SetAccess = private, Hidden = true)
         objectHandle;
     end
+    properties (Constant, Hidden = true)
+        align_ids = realsense.librealsense_mex('librealsense_mex', 'method_ids', 'rs2::align');
+    end
     methods
         % Constructor
         function this = align(align_to)
@@ -14,7 +17,7 @@ classdef align < handle
         % Destructor
         function delete(this)
             if (this.objectHandle ~= 0)
-                realsense.librealsense_mex('rs2::align', 'delete', this.objectHandle);
+                realsense.librealsense_mex(this.align_ids.delete, this.objectHandle);
             end
         end
         
@@ -25,7 +28,7 @@ classdef align < handle
             if ~frame.is('frameset')
                 error('Expected input number 2, frame, to be a frameset');
             end
-            out = realsense.librealsense_mex('rs2::align', 'process', this.objectHandle, frame.objectHandle);
+            out = realsense.librealsense_mex(this.align_ids.process, this.objectHandle, frame.objectHandle);
             frames = realsense.frameset(out);
         end
     end
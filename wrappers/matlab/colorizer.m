@@ -1,5 +1,8 @@
 % Wraps librealsense2 colorizer class
 classdef colorizer < realsense.options
+    properties (Constant, Hidden = true)
+        colorizer_ids = realsense.librealsense_mex('librealsense_mex', 'method_ids', 'rs2::colorizer');
+    end
     methods
         % Constructor
         function this = colorizer()
@@ -16,7 +19,7 @@ classdef colorizer < realsense.options
             if ~depth.is('depth_frame')
                 error('Expected input number 2, depth, to be a depth_frame');
             end
-            out = realsense.librealsense_mex('rs2::colorizer', 'colorize', this.objectHandle, depth.objectHandle);
+            out = realsense.librealsense_mex(this.colorizer_ids.colorize, this.objectHandle, depth.objectHandle);
             video_frame = realsense.video_frame(out);
         end
     end
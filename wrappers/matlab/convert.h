@@ -0,0 +1,70 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#if defined(_M_X64) || defined(__SSE2__)
+#include <emmintrin.h>
+#ifndef RS2_MATLAB_SSE2
+#define RS2_MATLAB_SSE2
+#endif
+#endif
+
+// Bulk element copies between C++ buffers and matlab arrays of basic types. When both sides have the
+// same type the copy is a memcpy, the widening and narrowing conversions that show up for frame data
+// and option arrays have SSE2 kernels, anything else is converted one element at a time.
+namespace convert
+{
+    template <typename To, typename From>
+    typename std::enable_if<std::is_same<To, From>::value>::type copy_elements(To* dst, const From* src, size_t n)
+    {
+        if (n) memcpy(dst, src, n * sizeof(To));
+    }
+
+    template <typename To, typename From>
+    typename std::enable_if<!std::is_same<To, From>::value>::type copy_elements(To* dst, const From* src, size_t n)
+    {
+        for (size_t i = 0; i < n; ++i) dst[i] = To(src[i]);
+    }
+
+#ifdef RS2_MATLAB_SSE2
+    // overloads are picked over the templates above
+    inline void copy_elements(double* dst, const float* src, size_t n)
+    {
+        size_t i = 0;
+        for (; i + 4 <= n; i += 4) {
+            const __m128 v = _mm_loadu_ps(src + i);
+            _mm_storeu_pd(dst + i, _mm_cvtps_pd(v));
+            _mm_storeu_pd(dst + i + 2, _mm_cvtps_pd(_mm_movehl_ps(v, v)));
+        }
+        for (; i < n; ++i) dst[i] = src[i];
+    }
+
+    inline void copy_elements(float* dst, const double* src, size_t n)
+    {
+        size_t i = 0;
+        for (; i + 4 <= n; i += 4) {
+            const __m128 lo = _mm_cvtpd_ps(_mm_loadu_pd(src + i));
+            const __m128 hi = _mm_cvtpd_ps(_mm_loadu_pd(src + i + 2));
+            _mm_storeu_ps(dst + i, _mm_movelh_ps(lo, hi));
+        }
+        for (; i < n; ++i) dst[i] = float(src[i]);
+    }
+
+    inline void copy_elements(double* dst, const uint16_t* src, size_t n)
+    {
+        const __m128i zero = _mm_setzero_si128();
+        size_t i = 0;
+        for (; i + 8 <= n; i += 8) {
+            const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+            const __m128i lo = _mm_unpacklo_epi16(v, zero), hi = _mm_unpackhi_epi16(v, zero);
+            _mm_storeu_pd(dst + i, _mm_cvtepi32_pd(lo));
+            _mm_storeu_pd(dst + i + 2, _mm_cvtepi32_pd(_mm_unpackhi_epi64(lo, lo)));
+            _mm_storeu_pd(dst + i + 4, _mm_cvtepi32_pd(hi));
+            _mm_storeu_pd(dst + i + 6, _mm_cvtepi32_pd(_mm_unpackhi_epi64(hi, hi)));
+        }
+        for (; i < n; ++i) dst[i] = src[i];
+    }
+#endif
+}
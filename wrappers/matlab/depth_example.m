@@ -25,10 +25,8 @@ function depth_example()
     % Colorize depth frame
     color = colorizer.colorize(depth);
 
-    % Get actual data and convert into a format imshow can use
-    % (Color data arrives as [R, G, B, R, G, B, ...] vector)
-    data = color.get_data();
-    img = permute(reshape(data',[3,color.get_width(),color.get_height()]),[3 2 1]);
+    % Get actual data as a HxWx3 image imshow can use
+    img = color.get_data(true);
 
     % Display image
     imshow(img);
@@ -1,5 +1,8 @@
 % Wraps librealsense2 depth_frame class
 classdef depth_frame < realsense.video_frame
+    properties (Constant, Hidden = true)
+        depth_frame_ids = realsense.librealsense_mex('librealsense_mex', 'method_ids', 'rs2::depth_frame');
+    end
     methods
         % Constructor
         function this = depth_frame(handle)
@@ -13,7 +16,22 @@ classdef depth_frame < realsense.video_frame
             narginchk(3, 3);
             validateattributes(x, {'numeric'}, {'scalar', 'nonnegative', 'real', 'integer'}, '', 'x', 2);
             validateattributes(y, {'numeric'}, {'scalar', 'nonnegative', 'real', 'integer'}, '', 'y', 2);
-            distance = realsense.librealsense_mex('rs2::depth_frame', 'get_distance', this.objectHandle, int64(x), int64(y));
+            distance = realsense.librealsense_mex(this.depth_frame_ids.get_distance, this.objectHandle, int64(x), int64(y));
+        end
+        function xyz = deproject(this, decimation, z_range)
+            % Organized point cloud in meters, xyz(y, x, :) is the point seen by pixel (x, y) of the
+            % decimated frame. Pixels without depth or outside z_range = [min max] are NaN
+            narginchk(1, 3);
+            if nargin == 1
+                decimation = 1;
+            end
+            validateattributes(decimation, {'numeric'}, {'scalar', 'positive', 'real', 'integer'}, '', 'decimation', 2);
+            if nargin < 3
+                xyz = realsense.librealsense_mex(this.depth_frame_ids.deproject, this.objectHandle, uint64(decimation));
+            else
+                validateattributes(z_range, {'numeric'}, {'vector', 'numel', 2, 'nonnegative', 'real', 'nondecreasing'}, '', 'z_range', 3);
+                xyz = realsense.librealsense_mex(this.depth_frame_ids.deproject, this.objectHandle, uint64(decimation), double(z_range));
+            end
         end
     end
 end
\ No newline at end of file
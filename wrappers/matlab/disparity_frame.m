@@ -1,5 +1,8 @@
 % Wraps librealsense2 disparity_frame class
 classdef disparity_frame < realsense.depth_frame
+    properties (Constant, Hidden = true)
+        disparity_frame_ids = realsense.librealsense_mex('librealsense_mex', 'method_ids', 'rs2::disparity_frame');
+    end
     methods
         % Constructor
         function this = disparity_frame(handle)
@@ -10,7 +13,7 @@ classdef disparity_frame < realsense.depth_frame
         
         % Functions
         function baseline = get_baseline(this)
-            baseline = realsense.librealsense_mex('rs2::disparity_frame', 'get_baseline', this.objectHandle);
+            baseline = realsense.librealsense_mex(this.disparity_frame_ids.get_baseline, this.objectHandle);
         end
     end
 end
\ No newline at end of file
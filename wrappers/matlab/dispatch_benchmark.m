@@ -0,0 +1,48 @@
+function results = dispatch_benchmark(calls)
+    % Measures the cost of a call through librealsense_mex when the function
+    % is named by strings and when it is named by its id
+    if nargin == 0
+        calls = 100000;
+    end
+    validateattributes(calls, {'numeric'}, {'scalar', 'positive', 'real', 'integer'}, '', 'calls', 1);
+
+    % A function that does nothing shows the overhead of the gateway alone
+    ids = realsense.librealsense_mex('librealsense_mex', 'method_ids', 'librealsense_mex');
+    tic;
+    for i = 1:calls
+        realsense.librealsense_mex('librealsense_mex', 'noop');
+    end
+    results.noop_by_name = toc / calls * 1e6;
+    tic;
+    for i = 1:calls
+        realsense.librealsense_mex(ids.noop);
+    end
+    results.noop_by_id = toc / calls * 1e6;
+
+    % Same measurement with a real function, if a camera is connected
+    ctx = realsense.context();
+    if numel(ctx.query_devices()) > 0
+        pipe = realsense.pipeline();
+        pipe.start();
+        fs = pipe.wait_for_frames();
+        handle = fs.objectHandle;
+        ids = realsense.librealsense_mex('librealsense_mex', 'method_ids', 'rs2::frame');
+        tic;
+        for i = 1:calls
+            realsense.librealsense_mex('rs2::frame', 'get_timestamp', handle);
+        end
+        results.get_timestamp_by_name = toc / calls * 1e6;
+        tic;
+        for i = 1:calls
+            realsense.librealsense_mex(ids.get_timestamp, handle);
+        end
+        results.get_timestamp_by_id = toc / calls * 1e6;
+        pipe.stop();
+    end
+
+    fprintf('Microseconds per call, %d calls\n', calls);
+    names = fieldnames(results);
+    for i = 1:numel(names)
+        fprintf('  %-24s %8.3f\n', names{i}, results.(names{i}));
+    end
+end
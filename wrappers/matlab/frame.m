@@ -3,6 +3,10 @@ classdef frame < handle
     properties (SetAccess = protected, Hidden = true)
         objectHandle;
     end
+    properties (Constant, Hidden = true)
+        % ids of the rs2::frame functions, passed to librealsense_mex instead of their names
+        frame_ids = realsense.librealsense_mex('librealsense_mex', 'method_ids', 'rs2::frame');
+    end
     methods
         % Constructor
         function this = frame(handle)
@@ -12,54 +16,60 @@ classdef frame < handle
         % Destructor
         function delete(this)
             if this.objectHandle ~= 0
-                realsense.librealsense_mex('rs2::frame', 'delete', this.objectHandle);
+                realsense.librealsense_mex(this.frame_ids.delete, this.objectHandle);
             end
         end
         
         % Functions
         % TODO: keep
         function l = logical(this)
-            l = realsense.librealsense_mex('rs2::frame', 'operator bool', this.objectHandle);
+            l = realsense.librealsense_mex(this.frame_ids.operator_bool, this.objectHandle);
         end
         function timestamp = get_timestamp(this)
-            timestamp = realsense.librealsense_mex('rs2::frame', 'get_timestamp', this.objectHandle);
+            timestamp = realsense.librealsense_mex(this.frame_ids.get_timestamp, this.objectHandle);
         end
         function domain = get_frame_timestamp_domain(this)
-            ret = realsense.librealsense_mex('rs2::frame', 'get_frame_timestamp_domain', this.objectHandle);
+            ret = realsense.librealsense_mex(this.frame_ids.get_frame_timestamp_domain, this.objectHandle);
             domain = realsense.timestamp_domain(ret);
         end
         function metadata = get_frame_metadata(this, frame_metadata)
             narginchk(2, 2);
             validateattributes(frame_metadata, {'realsense.frame_metadata_value', 'numeric'}, {'scalar', 'nonnegative', 'real', 'integer', '<=', realsense.frame_metadata_value.count}, '', 'frame_metadata', 2);
-            metadata = realsense.librealsense_mex('rs2::frame', 'get_frame_metadata', this.objectHandle, int64(frame_metadata));
+            metadata = realsense.librealsense_mex(this.frame_ids.get_frame_metadata, this.objectHandle, int64(frame_metadata));
         end
         function value = supports_frame_metadata(this, frame_metadata)
             narginchk(2, 2);
             validateattributes(frame_metadata, {'realsense.frame_metadata_value', 'numeric'}, {'scalar', 'nonnegative', 'real', 'integer', '<=', realsense.frame_metadata_value.count}, '', 'frame_metadata', 2);
-            value = realsense.librealsense_mex('rs2::frame', 'supports_frame_metadata', this.objectHandle, int64(frame_metadata));
+            value = realsense.librealsense_mex(this.frame_ids.supports_frame_metadata, this.objectHandle, int64(frame_metadata));
         end
         function frame_number = get_frame_number(this)
-            frame_number = realsense.librealsense_mex('rs2::frame', 'get_frame_number', this.objectHandle);
+            frame_number = realsense.librealsense_mex(this.frame_ids.get_frame_number, this.objectHandle);
         end
-        function data = get_data(this)
-            data = realsense.librealsense_mex('rs2::frame', 'get_data', this.objectHandle);
+        function data = get_data(this, shaped)
+            % With shaped = true, image data comes as HxW or HxWxC instead of a flat vector
+            narginchk(1, 2);
+            if nargin == 2 && shaped
+                data = realsense.librealsense_mex(this.frame_ids.get_data_shaped, this.objectHandle);
+            else
+                data = realsense.librealsense_mex(this.frame_ids.get_data, this.objectHandle);
+            end
         end
         function profile = get_profile(this)
-            ret = realsense.librealsense_mex('rs2::frame', 'get_profile', this.objectHandle);
+            ret = realsense.librealsense_mex(this.frame_ids.get_profile, this.objectHandle);
             profile = realsense.stream_profile(ret{:});
         end
         function value = is(this, type)
             narginchk(2, 2);
             % C++ function validates contents of type
             validateattributes(type, {'char', 'string'}, {'scalartext'}, '', 'type', 2);
-            out = realsense.librealsense_mex('rs2::frame', 'is', this.objectHandle, type);
+            out = realsense.librealsense_mex(this.frame_ids.is, this.objectHandle, type);
             value = logical(out);
         end
         function frame = as(this, type)
             narginchk(2, 2);
             % C++ function validates contents of type
             validateattributes(type, {'char', 'string'}, {'scalartext'}, '', 'type', 2);
-            out = realsense.librealsense_mex('rs2::frame', 'as', this.objectHandle, type);
+            out = realsense.librealsense_mex(this.frame_ids.as, this.objectHandle, type);
             switch type
                 case 'frame'
                     frame = realsense.frame(out);
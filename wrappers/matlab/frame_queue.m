@@ -3,6 +3,9 @@ classdef frame_queue < handle
     properties (SetAccess = private, Hidden = true)
         objectHandle;
     end
+    properties (Constant, Hidden = true)
+        frame_queue_ids = realsense.librealsense_mex('librealsense_mex', 'method_ids', 'rs2::frame_queue');
+    end
     methods
         % Constructor
         function this = frame_queue(capacity)
@@ -25,19 +28,19 @@ classdef frame_queue < handle
         function frame = wait_for_frame(this, timeout_ms)
             narginchk(1, 2);
             if nargin == 1
-                out = realsense.librealsense_mex('rs2::frame_queue', 'wait_for_frame', this.objectHandle);
+                out = realsense.librealsense_mex(this.frame_queue_ids.wait_for_frame, this.objectHandle);
             else
                 if isduration(timeout_ms)
                     timeout_ms = milliseconds(timeout_ms);
                 end
                 validateattributes(timeout_ms, {'numeric'}, {'scalar', 'nonnegative', 'real', 'integer'}, '', 'timeout_ms', 2);
-                out = realsense.librealsense_mex('rs2::frame_queue', 'wait_for_frame', this.objectHandle, double(timeout_ms));
+                out = realsense.librealsense_mex(this.frame_queue_ids.wait_for_frame, this.objectHandle, double(timeout_ms));
             end
             frame = realsense.frame(out);
         end
         % TODO: poll_for_frame [frame, video_frame, points, depth_frame, disparity_frame, motion_frame, pose_frame, frameset]
         function cap = capacity(this)
-            cap = realsense.librealsense_mex('rs2::frame_queue', 'capacity', this.objectHandle);
+            cap = realsense.librealsense_mex(this.frame_queue_ids.capacity, this.objectHandle);
         end
     end
 end
\ No newline at end of file
@@ -1,5 +1,8 @@
 % Wraps librealsense2 frameset class
 classdef frameset < realsense.frame
+    properties (Constant, Hidden = true)
+        frameset_ids = realsense.librealsense_mex('librealsense_mex', 'method_ids', 'rs2::frameset');
+    end
     methods
         % Constructor
         function this = frameset(handle)
@@ -12,25 +15,25 @@ classdef frameset < realsense.frame
         function frame = first_or_default(this, s)
             narginchk(2, 2);
             validateattributes(s, {'realsense.stream', 'numeric'}, {'scalar', 'nonnegative', 'real', 'integer', '<=', realsense.stream.count}, '', 's', 2);
-            ret = realsense.librealsense_mex('rs2::frameset', 'first_or_default', this.objectHandle, int64_t(s));
+            ret = realsense.librealsense_mex(this.frameset_ids.first_or_default, this.objectHandle, int64_t(s));
             frame = realsense.frame(ret);
         end
         function frame = first(this, s)
             narginchk(2, 2);
             validateattributes(s, {'realsense.stream', 'numeric'}, {'scalar', 'nonnegative', 'real', 'integer', '<=', realsense.stream.count}, '', 's', 2);
-            ret = realsense.librealsense_mex('rs2::frameset', 'first', this.objectHandle, int64_t(s));
+            ret = realsense.librealsense_mex(this.frameset_ids.first, this.objectHandle, int64_t(s));
             frame = realsense.frame(ret);
         end
         function depth_frame = get_depth_frame(this)
-            ret = realsense.librealsense_mex('rs2::frameset', 'get_depth_frame', this.objectHandle);
+            ret = realsense.librealsense_mex(this.frameset_ids.get_depth_frame, this.objectHandle);
             depth_frame = realsense.depth_frame(ret);
         end
         function color_frame = get_color_frame(this)
-            ret = realsense.librealsense_mex('rs2::frameset', 'get_color_frame', this.objectHandle);
+            ret = realsense.librealsense_mex(this.frameset_ids.get_color_frame, this.objectHandle);
             color_frame = realsense.video_frame(ret);
         end
         function infrared_frame = get_infrared_frame(this)
-            ret = realsense.librealsense_mex('rs2::frameset', 'get_infrared_frame', this.objectHandle);
+            ret = realsense.librealsense_mex(this.frameset_ids.get_infrared_frame, this.objectHandle);
             infrared_frame = realsense.video_frame(ret);
         end
         function size = get_size(this)
@@ -0,0 +1,33 @@
+function handle_check(filename)
+    % Checks that cloned stream profiles are released when Matlab clears them.
+    % Streams from the given rosbag file, or from a connected camera if there is none
+    pipe = realsense.pipeline();
+    if nargin == 0
+        profile = pipe.start();
+    else
+        validateattributes(filename, {'char','string'}, {'scalartext', 'nonempty'}, '', 'filename', 1);
+        cfg = realsense.config();
+        cfg.enable_device_from_file(filename);
+        profile = pipe.start(cfg);
+    end
+    streams = profile.get_streams();
+    original = streams{1};
+
+    before = realsense.handle_stats();
+    clones = cell(1, 10);
+    for i = 1:numel(clones)
+        clones{i} = original.clone(original.stream_type(), i, original.format());
+    end
+    during = realsense.handle_stats();
+    clear clones;
+    after = realsense.handle_stats();
+    pipe.stop();
+
+    assert(during.stream_profiles.live == before.stream_profiles.live + 10, ...
+        'Expected 10 more live stream profiles after cloning, got %d', ...
+        during.stream_profiles.live - before.stream_profiles.live);
+    assert(after.stream_profiles.live == before.stream_profiles.live, ...
+        '%d cloned stream profiles were not released', ...
+        after.stream_profiles.live - before.stream_profiles.live);
+    fprintf('Cloned stream profiles are released, %d live before and after\n', after.stream_profiles.live);
+end
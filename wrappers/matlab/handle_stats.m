@@ -0,0 +1,5 @@
+function stats = handle_stats()
+    % Counts of the frames and stream profiles currently held by Matlab objects.
+    % A live count that keeps growing points at objects that are never deleted
+    stats = realsense.librealsense_mex('librealsense_mex', 'handle_stats');
+end
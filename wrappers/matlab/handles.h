@@ -0,0 +1,90 @@
+#pragma once
+#include "mex.h"
+#include <cstdint>
+#include <deque>
+#include <utility>
+#include <vector>
+
+// Objects that matlab creates and drops at a high rate (frames, cloned stream profiles) are kept in a
+// slab of slots instead of being heap allocated one by one. Matlab gets a 64 bit id: the low 32 bits
+// are the slot index + 1, so that 0 is never a valid id, and the high 32 bits are the generation of the
+// slot, which is bumped whenever the slot is freed. An id that outlived its object is detected instead
+// of silently reaching whatever object reused the slot.
+template <typename T>
+class handle_slab
+{
+private:
+    struct slot {
+        T value;
+        uint32_t generation;
+        bool live;
+        slot() : value(), generation(1), live(false) {}
+    };
+    // deque so that references returned by get stay valid while other objects are added
+    std::deque<slot> slots;
+    std::vector<uint32_t> free_slots;
+    size_t live_count;
+    size_t peak_count;
+
+    slot* find(uint64_t id)
+    {
+        const uint64_t index = (id & 0xffffffff) - 1;
+        if (index >= slots.size()) return nullptr;
+        auto& s = slots[static_cast<size_t>(index)];
+        if (!s.live || s.generation != static_cast<uint32_t>(id >> 32)) return nullptr;
+        return &s;
+    }
+public:
+    handle_slab() : slots(), free_slots(), live_count(0), peak_count(0) {}
+
+    uint64_t add(T&& value)
+    {
+        uint32_t index;
+        if (free_slots.empty()) {
+            index = static_cast<uint32_t>(slots.size());
+            slots.emplace_back();
+        }
+        else {
+            index = free_slots.back();
+            free_slots.pop_back();
+        }
+        auto& s = slots[index];
+        s.value = std::move(value);
+        s.live = true;
+        // the mex file stays locked for as long as matlab holds any object of the slab
+        if (live_count++ == 0) mexLock();
+        if (live_count > peak_count) peak_count = live_count;
+        return (uint64_t(s.generation) << 32) | (index + 1);
+    }
+
+    // nullptr if the id doesn't refer to a live object
+    T* get(uint64_t id)
+    {
+        auto s = find(id);
+        return s ? &s->value : nullptr;
+    }
+
+    bool remove(uint64_t id)
+    {
+        auto s = find(id);
+        if (!s) return false;
+        s->value = T();
+        s->live = false;
+        ++s->generation;
+        free_slots.push_back(static_cast<uint32_t>((id & 0xffffffff) - 1));
+        if (--live_count == 0) mexUnlock();
+        return true;
+    }
+
+    size_t live() const { return live_count; }
+    size_t peak() const { return peak_count; }
+    size_t capacity() const { return slots.size(); }
+};
+
+// The slab of each type of object, shared by everything that wraps or parses that type
+template <typename T>
+handle_slab<T>& slab()
+{
+    static handle_slab<T> instance;
+    return instance;
+}
@@ -1,6 +1,12 @@
 #include "MatlabParamParser.h"
 #include "Factory.h"
+#include "transpose.h"
 #include "librealsense2/rs.hpp"
+#include "librealsense2/rsutil.h"
+#include <cctype>
+#include <cstring>
+#include <limits>
+#include <thread>
 
 #pragma comment(lib, "libmx.lib")
 #pragma comment(lib, "libmex.lib")
@@ -9,6 +15,163 @@
 
 Factory *factory;
 
+// How a frame is sent to matlab by the shaped functions: an h x w x channels array of type
+struct shaped_layout {
+    rs2_format format;
+    mxClassID type;
+    size_t w, h, channels, stride, element_size;
+    bool operator==(const shaped_layout& o) const { return format == o.format && w == o.w && h == o.h; }
+};
+
+static bool get_shaped_layout(const rs2::frame& f, shaped_layout& layout)
+{
+    auto profile = f.get_profile().as<rs2::video_stream_profile>();
+    if (!profile) return false;
+
+    layout.format = profile.format();
+    layout.w = profile.width();
+    layout.h = profile.height();
+    switch (layout.format) {
+    case RS2_FORMAT_Z16: case RS2_FORMAT_DISPARITY16:
+    case RS2_FORMAT_Y16: case RS2_FORMAT_RAW16:
+        layout.type = mxUINT16_CLASS; layout.element_size = 2; layout.channels = 1; break;
+    case RS2_FORMAT_Y8: case RS2_FORMAT_RAW8:
+        layout.type = mxUINT8_CLASS; layout.element_size = 1; layout.channels = 1; break;
+    case RS2_FORMAT_RGB8: case RS2_FORMAT_BGR8:
+        layout.type = mxUINT8_CLASS; layout.element_size = 1; layout.channels = 3; break;
+    case RS2_FORMAT_RGBA8: case RS2_FORMAT_BGRA8:
+        layout.type = mxUINT8_CLASS; layout.element_size = 1; layout.channels = 4; break;
+    case RS2_FORMAT_XYZ32F:
+        layout.type = mxSINGLE_CLASS; layout.element_size = 4; layout.channels = 3; break;
+    case RS2_FORMAT_DISPARITY32:
+        layout.type = mxSINGLE_CLASS; layout.element_size = 4; layout.channels = 1; break;
+    default:
+        return false;
+    }
+    if (auto vf = f.as<rs2::video_frame>()) layout.stride = vf.get_stride_in_bytes();
+    else layout.stride = layout.w * layout.channels * layout.element_size; // points
+    return true;
+}
+
+// dst must have room for the h x w x channels elements described by layout
+static void copy_shaped(const rs2::frame& f, const shaped_layout& layout, void* dst)
+{
+    const void* src = f.get_data();
+    const int bgr[] = { 2, 1, 0, 3 };
+    const size_t w = layout.w, h = layout.h, stride = layout.stride;
+    switch (layout.format) {
+    case RS2_FORMAT_Z16: case RS2_FORMAT_DISPARITY16:
+    case RS2_FORMAT_Y16: case RS2_FORMAT_RAW16:
+        transpose::to_column_major<uint16_t, 1>(src, stride, w, h, static_cast<uint16_t*>(dst)); break;
+    case RS2_FORMAT_Y8: case RS2_FORMAT_RAW8:
+        transpose::to_column_major<uint8_t, 1>(src, stride, w, h, static_cast<uint8_t*>(dst)); break;
+    case RS2_FORMAT_RGB8: case RS2_FORMAT_BGR8:
+        transpose::to_column_major<uint8_t, 3>(src, stride, w, h, static_cast<uint8_t*>(dst),
+            layout.format == RS2_FORMAT_BGR8 ? bgr : nullptr);
+        break;
+    case RS2_FORMAT_RGBA8: case RS2_FORMAT_BGRA8:
+        transpose::to_column_major<uint8_t, 4>(src, stride, w, h, static_cast<uint8_t*>(dst),
+            layout.format == RS2_FORMAT_BGRA8 ? bgr : nullptr);
+        break;
+    case RS2_FORMAT_XYZ32F:
+        transpose::to_column_major<float, 3>(src, stride, w, h, static_cast<float*>(dst)); break;
+    case RS2_FORMAT_DISPARITY32:
+        transpose::to_column_major<float, 1>(src, stride, w, h, static_cast<float*>(dst)); break;
+    default:
+        break;
+    }
+}
+
+// Sends per point data (C floats per point) of a points frame as an n x C matrix. With drop_zeros, points
+// without depth are left out so that rows of vertices and texture coordinates still match.
+template <int C>
+static mxArray* wrap_points(const rs2::points& points, const float* data, bool single, bool drop_zeros)
+{
+    size_t n = points.size();
+    std::vector<uint32_t> index;
+    if (drop_zeros) {
+        auto vertices = points.get_vertices();
+        index.reserve(n);
+        for (uint32_t i = 0; i < n; ++i)
+            if (vertices[i].z) index.push_back(i);
+        n = index.size();
+    }
+    auto ind = drop_zeros ? index.data() : nullptr;
+    auto cells = mxCreateNumericMatrix(n, C, single ? mxSINGLE_CLASS : mxDOUBLE_CLASS, mxREAL);
+    if (single) transpose::to_columns<float, C>(data, n, static_cast<float*>(mxGetData(cells)), ind);
+    else transpose::to_columns<double, C>(data, n, static_cast<double*>(mxGetData(cells)), ind);
+    return cells;
+}
+
+// Deprojects a depth frame into an organized h x w x 3 cloud, keeping every decimation-th pixel of every
+// decimation-th row. Pixels without depth or outside [z_min, z_max] meters are NaN.
+static mxArray* deproject_depth(const rs2::depth_frame& depth, size_t decimation, float z_min, float z_max)
+{
+    auto profile = depth.get_profile().as<rs2::video_stream_profile>();
+    auto intrin = profile.get_intrinsics();
+
+    rs2_error* e = nullptr;
+    auto sensor = rs2_get_frame_sensor(depth.get(), &e);
+    rs2::error::handle(e);
+    auto units = rs2_get_depth_scale(sensor, &e);
+    rs2_delete_sensor(sensor);
+    rs2::error::handle(e);
+
+    const size_t w = intrin.width / decimation, h = intrin.height / decimation, plane = w * h;
+    mwSize dims[] = { h, w, 3 };
+    auto cells = mxCreateNumericArray(3, dims, mxSINGLE_CLASS, mxREAL);
+    auto dst = static_cast<float*>(mxGetData(cells));
+
+    // The ray through each output pixel only depends on the intrinsics, so it is kept across calls.
+    // Deprojecting at a depth of 1 handles every distortion model, after that a point is ray * z.
+    static std::vector<float> rays;
+    static rs2_intrinsics rays_intrin = {};
+    static size_t rays_decimation = 0;
+    if (rays_decimation != decimation || memcmp(&rays_intrin, &intrin, sizeof(intrin)) != 0) {
+        rays.resize(plane * 2);
+        for (size_t y = 0; y < h; ++y) for (size_t x = 0; x < w; ++x) {
+            float pixel[] = { float(x * decimation), float(y * decimation) }, point[3];
+            rs2_deproject_pixel_to_point(point, &intrin, pixel, 1.f);
+            rays[(y * w + x) * 2] = point[0];
+            rays[(y * w + x) * 2 + 1] = point[1];
+        }
+        rays_intrin = intrin;
+        rays_decimation = decimation;
+    }
+
+    const auto data = static_cast<const uint8_t*>(depth.get_data());
+    const size_t stride = depth.get_stride_in_bytes();
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+    auto work = [&](size_t y0, size_t y1) {
+        // columns are written top to bottom so that the output is written contiguously
+        for (size_t x = 0; x < w; ++x) {
+            for (size_t y = y0; y < y1; ++y) {
+                auto raw = reinterpret_cast<const uint16_t*>(data + y * decimation * stride)[x * decimation];
+                const float z = raw * units;
+                const size_t i = x * h + y;
+                if (raw == 0 || z < z_min || z > z_max) {
+                    dst[i] = dst[plane + i] = dst[2 * plane + i] = nan;
+                    continue;
+                }
+                const float* ray = &rays[(y * w + x) * 2];
+                dst[i] = ray[0] * z;
+                dst[plane + i] = ray[1] * z;
+                dst[2 * plane + i] = z;
+            }
+        }
+    };
+
+    // split the rows between threads, threads only touch plain memory and never call the mex API
+    const size_t workers = std::max<size_t>(1, std::min<size_t>(std::thread::hardware_concurrency(), h / 32));
+    std::vector<std::thread> threads;
+    const size_t rows = (h + workers - 1) / workers;
+    for (size_t t = 1; t < workers; ++t)
+        threads.emplace_back(work, std::min(h, t * rows), std::min(h, (t + 1) * rows));
+    work(0, std::min(h, rows));
+    for (auto& t : threads) t.join();
+    return cells;
+}
+
 void make_factory(){
     factory = new Factory();
 
@@ -166,39 +329,39 @@ void make_factory(){
         // rs2::frame::keep                                             [TODO/HOW]
         frame_factory.record("operator bool", 1, 1, [](int outc, mxArray* outv[], int inc, const mxArray* inv[])
         {
-            auto thiz = MatlabParamParser::parse<rs2::frame>(inv[0]);
+            auto& thiz = MatlabParamParser::parse<rs2::frame>(inv[0]);
             outv[0] = MatlabParamParser::wrap(bool(thiz));
         });
         frame_factory.record("get_timestamp", 1, 1, [](int outc, mxArray* outv[], int inc, const mxArray* inv[])
         {
-            auto thiz = MatlabParamParser::parse<rs2::frame>(inv[0]);
+            auto& thiz = MatlabParamParser::parse<rs2::frame>(inv[0]);
             outv[0] = MatlabParamParser::wrap(thiz.get_timestamp());
         });
         frame_factory.record("get_frame_timestamp_domain", 1, 1, [](int outc, mxArray* outv[], int inc, const mxArray* inv[])
         {
-            auto thiz = MatlabParamParser::parse<rs2::frame>(inv[0]);
+            auto& thiz = MatlabParamParser::parse<rs2::frame>(inv[0]);
             outv[0] = MatlabParamParser::wrap(thiz.get_frame_timestamp_domain());
         });
         frame_factory.record("get_frame_metadata", 1, 2, [](int outc, mxArray* outv[], int inc, const mxArray* inv[])
         {
-            auto thiz = MatlabParamParser::parse<rs2::frame>(inv[0]);
+            auto& thiz = MatlabParamParser::parse<rs2::frame>(inv[0]);
             auto frame_metadata = MatlabParamParser::parse<rs2_frame_metadata_value>(inv[1]);
             outv[0] = MatlabParamParser::wrap(thiz.get_frame_metadata(frame_metadata));
         });
         frame_factory.record("supports_frame_metadata", 1, 2, [](int outc, mxArray* outv[], int inc, const mxArray* inv[])
         {
-            auto thiz = MatlabParamParser::parse<rs2::frame>(inv[0]);
+            auto& thiz = MatlabParamParser::parse<rs2::frame>(inv[0]);
             auto frame_metadata = MatlabParamParser::parse<rs2_frame_metadata_value>(inv[1]);
             outv[0] = MatlabParamParser::wrap(thiz.supports_frame_metadata(frame_metadata));
         });
         frame_factory.record("get_frame_number", 1, 1, [](int outc, mxArray* outv[], int inc, const mxArray* inv[])
         {
-            auto thiz = MatlabParamParser::parse<rs2::frame>(inv[0]);
+            auto& thiz = MatlabParamParser::parse<rs2::frame>(inv[0]);
             outv[0] = MatlabParamParser::wrap(thiz.get_frame_number());
         });
         frame_factory.record("get_data", 1, 1, [](int outc, mxArray* outv[], int inc, const mxArray* inv[])
         {
-            auto thiz = MatlabParamParser::parse<rs2::frame>(inv[0]);
+            auto& thiz = MatlabParamParser::parse<rs2::frame>(inv[0]);
             size_t n_bytes = 0;
             if (auto vf = thiz.as<rs2::video_frame>()) {
                 n_bytes = vf.get_height() * vf.get_stride_in_bytes();
@@ -249,15 +412,28 @@ void make_factory(){
                 outv[0] = MatlabParamParser::wrap_array(reinterpret_cast<const uint8_t*>(thiz.get_data()), n_bytes);
             }
         });
+        frame_factory.record("get_data#shaped", 1, 1, [](int outc, mxArray* outv[], int inc, const mxArray* inv[])
+        {
+            // Same data as get_data, already laid out the way matlab indexes images: HxW for single
+            // channel formats, HxWxC for color and XYZ. RGB and BGR based formats are both sent in RGB order.
+            auto& thiz = MatlabParamParser::parse<rs2::frame>(inv[0]);
+            shaped_layout layout;
+            if (!get_shaped_layout(thiz, layout))
+                mexErrMsgTxt("rs2::frame::get_data: shaped data isn't supported for this frame");
+
+            mwSize dims[] = { layout.h, layout.w, layout.channels };
+            outv[0] = mxCreateNumericArray(layout.channels == 1 ? 2 : 3, dims, layout.type, mxREAL);
+            copy_shaped(thiz, layout, mxGetData(outv[0]));
+        });
         frame_factory.record("get_profile", 1, 1, [](int outc, mxArray* outv[], int inc, const mxArray* inv[])
         {
-            auto thiz = MatlabParamParser::parse<rs2::frame>(inv[0]);
+            auto& thiz = MatlabParamParser::parse<rs2::frame>(inv[0]);
             outv[0] = MatlabParamParser::wrap(thiz.get_profile());
         });
         frame_factory.record("is", 1, 2, [](int outc, mxArray* outv[], int inc, const mxArray* inv[])
         {
             // TODO: something more maintainable?
-            auto thiz = MatlabParamParser::parse<rs2::frame>(inv[0]);
+            auto& thiz = MatlabParamParser::parse<rs2::frame>(inv[0]);
             auto type = MatlabParamParser::parse<std::string>(inv[1]);
             if (type == "frame")
                 outv[0] = MatlabParamParser::wrap(thiz.is<rs2::frame>());
@@ -283,7 +459,7 @@ void make_factory(){
         frame_factory.record("as", 1, 2, [](int outc, mxArray* outv[], int inc, const mxArray* inv[])
         {
             // TODO: something more maintainable?
-            auto thiz = MatlabParamParser::parse<rs2::frame>(inv[0]);
+            auto& thiz = MatlabParamParser::parse<rs2::frame>(inv[0]);
             auto type = MatlabParamParser::parse<std::string>(inv[1]);
             if (type == "frame")
                 outv[0] = MatlabParamParser::wrap(thiz.as<rs2::frame>());
@@ -346,11 +522,16 @@ void make_factory(){
         ClassFactory points_factory("rs2::points");
         // rs2::points::constructor()                                   [?]
         // rs2::points::constrcutor(rs2::frame)                         [?]
-        points_factory.record("get_vertices", 1, 1, [](int outc, mxArray* outv[], int inc, const mxArray* inv[])
+        points_factory.record("get_vertices", 1, 1, 3, [](int outc, mxArray* outv[], int inc, const mxArray* inv[])
         {
             auto thiz = MatlabParamParser::parse<rs2::points>(inv[0]);
-            // TODO: turn into matrix instead of column?
-            outv[0] = MatlabParamParser::wrap_array(thiz.get_vertices(), thiz.size());
+            if (inc == 1) {
+                outv[0] = MatlabParamParser::wrap_array(thiz.get_vertices(), thiz.size());
+                return;
+            }
+            auto single = MatlabParamParser::parse<bool>(inv[1]);
+            auto drop_zeros = MatlabParamParser::parse<bool>(inv[2]);
+            outv[0] = wrap_points<3>(thiz, reinterpret_cast<const float*>(thiz.get_vertices()), single, drop_zeros);
         });
         points_factory.record("export_to_ply", 0, 3, [](int outc, mxArray* outv[], int inc, const mxArray* inv[])
         {
@@ -359,11 +540,16 @@ void make_factory(){
             auto texture = MatlabParamParser::parse<rs2::video_frame>(inv[2]);
             thiz.export_to_ply(fname, texture);
         });
-        points_factory.record("get_texture_coordinates", 1, 1, [](int outc, mxArray* outv[], int inc, const mxArray* inv[])
+        points_factory.record("get_texture_coordinates", 1, 1, 3, [](int outc, mxArray* outv[], int inc, const mxArray* inv[])
         {
             auto thiz = MatlabParamParser::parse<rs2::points>(inv[0]);
-            // TODO: turn into matrix instead of column?
-            outv[0] = MatlabParamParser::wrap_array(thiz.get_texture_coordinates(), thiz.size());
+            if (inc == 1) {
+                outv[0] = MatlabParamParser::wrap_array(thiz.get_texture_coordinates(), thiz.size());
+                return;
+            }
+            auto single = MatlabParamParser::parse<bool>(inv[1]);
+            auto drop_zeros = MatlabParamParser::parse<bool>(inv[2]);
+            outv[0] = wrap_points<2>(thiz, reinterpret_cast<const float*>(thiz.get_texture_coordinates()), single, drop_zeros);
         });
         points_factory.record("size", 1, 1, [](int outc, mxArray* outv[], int inc, const mxArray* inv[])
         {
@@ -386,6 +572,21 @@ void make_factory(){
             auto y = MatlabParamParser::parse<int>(inv[2]);
             outv[0] = MatlabParamParser::wrap(thiz.get_distance(x, y));
         });
+        depth_frame_factory.record("deproject", 1, 1, 3, [](int outc, mxArray* outv[], int inc, const mxArray* inv[])
+        {
+            auto thiz = MatlabParamParser::parse<rs2::depth_frame>(inv[0]);
+            size_t decimation = 1;
+            float z_min = 0, z_max = std::numeric_limits<float>::infinity();
+            if (inc >= 2) decimation = MatlabParamParser::parse<size_t>(inv[1]);
+            if (inc == 3) {
+                auto range = MatlabParamParser::parse<std::vector<double>>(inv[2]);
+                if (range.size() != 2) mexErrMsgTxt("rs2::depth_frame::deproject: z range must be [min max]");
+                z_min = float(range[0]);
+                z_max = float(range[1]);
+            }
+            if (decimation == 0) mexErrMsgTxt("rs2::depth_frame::deproject: decimation must be positive");
+            outv[0] = deproject_depth(thiz, decimation, z_min, z_max);
+        });
         factory->record(depth_frame_factory);
     }
     {
@@ -1322,6 +1523,46 @@ void make_factory(){
                 outv[0] = MatlabParamParser::wrap(thiz.wait_for_frames(timeout_ms));
             }
         });
+        pipeline_factory.record("capture", 2, 3, 4, [](int outc, mxArray* outv[], int inc, const mxArray* inv[])
+        {
+            // Waits for n framesets and stacks the shaped data of one of their streams into a single
+            // HxWxN (or HxWxCxN) array, along with the 1xN timestamps of the frames. Everything happens
+            // in this call so a burst of frames costs one trip through the gateway.
+            auto thiz = MatlabParamParser::parse<rs2::pipeline>(inv[0]);
+            auto n = MatlabParamParser::parse<size_t>(inv[1]);
+            auto stream = MatlabParamParser::parse<rs2_stream>(inv[2]);
+            unsigned int timeout_ms = RS2_DEFAULT_TIMEOUT;
+            if (inc == 4) timeout_ms = MatlabParamParser::parse<unsigned int>(inv[3]);
+            if (n == 0) mexErrMsgTxt("rs2::pipeline::capture: at least one frame must be captured");
+
+            shaped_layout layout;
+            uint8_t* data = nullptr;
+            size_t frame_bytes = 0;
+            outv[1] = mxCreateNumericMatrix(1, n, mxDOUBLE_CLASS, mxREAL);
+            auto timestamps = static_cast<double*>(mxGetData(outv[1]));
+            for (size_t i = 0; i < n; ++i) {
+                auto fs = thiz.wait_for_frames(timeout_ms);
+                auto f = fs.first_or_default(stream);
+                if (!f) mexErrMsgTxt("rs2::pipeline::capture: the pipeline doesn't stream the requested stream");
+
+                shaped_layout current;
+                if (!get_shaped_layout(f, current))
+                    mexErrMsgTxt("rs2::pipeline::capture: shaped data isn't supported for this stream's format");
+                if (i == 0) {
+                    // allocate once the size of the frames is known
+                    layout = current;
+                    mwSize dims[] = { layout.h, layout.w, layout.channels, n };
+                    if (layout.channels == 1) dims[2] = n;
+                    outv[0] = mxCreateNumericArray(layout.channels == 1 ? 3 : 4, dims, layout.type, mxREAL);
+                    data = static_cast<uint8_t*>(mxGetData(outv[0]));
+                    frame_bytes = layout.h * layout.w * layout.channels * layout.element_size;
+                }
+                else if (!(current == layout))
+                    mexErrMsgTxt("rs2::pipeline::capture: the stream changed resolution or format during the capture");
+                copy_shaped(f, layout, data + i * frame_bytes);
+                timestamps[i] = f.get_timestamp();
+            }
+        });
         // rs2::pipeline::poll_for_frames                               [TODO/HOW] [multi-output?]
         pipeline_factory.record("get_active_profile", 1, 1, [](int outc, mxArray* outv[], int inc, const mxArray* inv[])
         {
@@ -1354,6 +1595,55 @@ void make_factory(){
         });
     }
 
+    // gateway internals
+    {
+        ClassFactory mex_factory("librealsense_mex");
+        mex_factory.record("method_ids", 1, 1, [](int outc, mxArray* outv[], int inc, const mxArray* inv[])
+        {
+            // struct of the ids of every function of a class, for the .m files to pass instead of
+            // the class and function names. Function names are turned into valid field names,
+            // eg "operator bool" -> operator_bool, "operator==" -> operator_eq, "open#vec" -> open_vec
+            auto cname = MatlabParamParser::parse<std::string>(inv[0]);
+            auto cls = factory->get_class(cname);
+            if (!cls) mexErrMsgTxt(("librealsense_mex::method_ids: unknown class " + cname).c_str());
+
+            outv[0] = mxCreateStructMatrix(1, 1, 0, nullptr);
+            for (auto& func : cls->get_funcs()) {
+                std::string field;
+                for (size_t i = 0; i < func.first.size(); ++i) {
+                    if (func.first.compare(i, 2, "==") == 0) { field += "_eq"; ++i; }
+                    else if (isalnum(static_cast<unsigned char>(func.first[i]))) field += func.first[i];
+                    else field += '_';
+                }
+                mxAddField(outv[0], field.c_str());
+                mxSetField(outv[0], 0, field.c_str(), MatlabParamParser::wrap(uint32_t(func.second.id)));
+            }
+        });
+        mex_factory.record("handle_stats", 1, 0, [](int outc, mxArray* outv[], int inc, const mxArray* inv[])
+        {
+            // live, peak and allocated slot counts of each handle slab, to find objects matlab never deletes
+            auto stats = [](size_t live, size_t peak, size_t capacity) {
+                const char* fnames[] = { "live", "peak", "capacity" };
+                mxArray* cell = mxCreateStructMatrix(1, 1, 3, fnames);
+                mxSetField(cell, 0, "live", MatlabParamParser::wrap(std::move(live)));
+                mxSetField(cell, 0, "peak", MatlabParamParser::wrap(std::move(peak)));
+                mxSetField(cell, 0, "capacity", MatlabParamParser::wrap(std::move(capacity)));
+                return cell;
+            };
+            auto& frames = slab<rs2::frame>();
+            auto& profiles = slab<std::shared_ptr<rs2_stream_profile>>();
+            const char* fnames[] = { "frames", "stream_profiles" };
+            outv[0] = mxCreateStructMatrix(1, 1, 2, fnames);
+            mxSetField(outv[0], 0, "frames", stats(frames.live(), frames.peak(), frames.capacity()));
+            mxSetField(outv[0], 0, "stream_profiles", stats(profiles.live(), profiles.peak(), profiles.capacity()));
+        });
+        mex_factory.record("noop", 0, 0, 16, [](int outc, mxArray* outv[], int inc, const mxArray* inv[])
+        {
+            // does nothing, used to measure the cost of a call through the gateway
+        });
+        factory->record(mex_factory);
+    }
+
     mexAtExit([]() { delete factory; });
 }
 
@@ -1362,32 +1652,42 @@ void mexFunction(int nOutParams, mxArray *outParams[], int nInParams, const mxAr
     // does this need to be made threadsafe? also maybe better idea than global object?
     if (!factory) make_factory();
 
-    if (nInParams < 2) {
+    // Functions are called either as (class name, function name, args...) or, from the .m files,
+    // as (function id, args...), see Factory
+    const func_data* f_data;
+    int skip;
+    if (nInParams >= 1 && !mxIsChar(inParams[0])) {
+        f_data = factory->get(static_cast<uint32_t>(mxGetScalar(inParams[0])));
+        skip = 1;
+    }
+    else if (nInParams >= 2) {
+        auto cname = MatlabParamParser::parse<std::string>(inParams[0]);
+        auto fname = MatlabParamParser::parse<std::string>(inParams[1]);
+        f_data = factory->get(cname, fname);
+        skip = 2;
+    }
+    else {
         mexErrMsgTxt("At least class and command name are needed.");
         return;
     }
-    
-    auto cname = MatlabParamParser::parse<std::string>(inParams[0]);
-    auto fname = MatlabParamParser::parse<std::string>(inParams[1]);
 
-    auto f_data = factory->get(cname, fname);
-    if (!f_data.f) {
+    if (!f_data) {
         mexErrMsgTxt("Unknown Command received.");
         return;
     }
 
-    if (f_data.out != nOutParams) {
-        std::string errmsg = cname + "::" + fname.substr(0, fname.find("#", 0)) + ": Wrong number of outputs";
+    if (f_data->out != nOutParams) {
+        std::string errmsg = f_data->name + ": Wrong number of outputs";
         mexErrMsgTxt(errmsg.c_str());
     }
 
-    if (f_data.in_min > nInParams - 2 || f_data.in_max < nInParams - 2) {
-        std::string errmsg = cname + "::" + fname.substr(0, fname.find("#", 0)) + ": Wrong number of inputs";
+    if (f_data->in_min > nInParams - skip || f_data->in_max < nInParams - skip) {
+        std::string errmsg = f_data->name + ": Wrong number of inputs";
         mexErrMsgTxt(errmsg.c_str());
     }
     
     try {
-        f_data.f(nOutParams, outParams, nInParams - 2, inParams + 2); // "eat" the two function specifiers
+        f_data->f(nOutParams, outParams, nInParams - skip, inParams + skip); // "eat" the function specifiers
     } catch (std::exception &e) {
         mexErrMsgTxt(e.what());
     } catch (...) {
@@ -1,5 +1,8 @@
 % Wraps librealsense2 motion_frame class
 classdef motion_frame < realsense.frame
+    properties (Constant, Hidden = true)
+        motion_frame_ids = realsense.librealsense_mex('librealsense_mex', 'method_ids', 'rs2::motion_frame');
+    end
     methods
         % Constructor
         function this = motion_frame(handle)
@@ -10,7 +13,7 @@ classdef motion_frame < realsense.frame
         
         % Functions
         function motion_data = get_motion_data(this)
-            motion_data = realsense.librealsense_mex('rs2::motion_frame', 'get_motion_data', this.objectHandle);
+            motion_data = realsense.librealsense_mex(this.motion_frame_ids.get_motion_data, this.objectHandle);
         end
     end
 end
\ No newline at end of file
@@ -3,6 +3,9 @@ classdef pipeline < handle
     properties (SetAccess = protected, Hidden = true)
         objectHandle;
     end
+    properties (Constant, Hidden = true)
+        pipeline_ids = realsense.librealsense_mex('librealsense_mex', 'method_ids', 'rs2::pipeline');
+    end
     methods
         % Constructor
         function this = pipeline(ctx)
@@ -16,7 +19,7 @@ classdef pipeline < handle
         % Destructor
         function delete(this)
             if (this.objectHandle ~= 0)
-                realsense.librealsense_mex('rs2::pipeline', 'delete', this.objectHandle);
+                realsense.librealsense_mex(this.pipeline_ids.delete, this.objectHandle);
             end
         end
 
@@ -24,32 +27,48 @@ classdef pipeline < handle
         function pipeline_profile = start(this, config)
             narginchk(1, 2);
             if nargin == 1
-                out = realsense.librealsense_mex('rs2::pipeline', 'start', this.objectHandle);
+                out = realsense.librealsense_mex(this.pipeline_ids.start, this.objectHandle);
             else
                 validateattributes(config, {'realsense.config'}, {'scalar'}, '', 'config', 2);
-                out = realsense.librealsense_mex('rs2::pipeline', 'start', this.objectHandle, config.objectHandle);
+                out = realsense.librealsense_mex(this.pipeline_ids.start, this.objectHandle, config.objectHandle);
             end
             pipeline_profile = realsense.pipeline_profile(out);
         end
         function stop(this)
-            realsense.librealsense_mex('rs2::pipeline', 'stop', this.objectHandle);
+            realsense.librealsense_mex(this.pipeline_ids.stop, this.objectHandle);
         end
         function frames = wait_for_frames(this, timeout_ms)
             narginchk(1, 2);
             if nargin == 1
-                out = realsense.librealsense_mex('rs2::pipeline', 'wait_for_frames', this.objectHandle);
+                out = realsense.librealsense_mex(this.pipeline_ids.wait_for_frames, this.objectHandle);
             else
                 if isduration(timeout_ms)
                     timeout_ms = milliseconds(timeout_ms);
                 end
                 validateattributes(timeout_ms, {'numeric'}, {'scalar', 'nonnegative', 'real', 'integer'}, '', 'timeout_ms', 2);
-                out = realsense.librealsense_mex('rs2::pipeline', 'wait_for_frames', this.objectHandle, double(timeout_ms));
+                out = realsense.librealsense_mex(this.pipeline_ids.wait_for_frames, this.objectHandle, double(timeout_ms));
             end
             frames = realsense.frameset(out);
         end
+        function [data, timestamps] = capture(this, n, stream, timeout_ms)
+            % Captures n frames of a stream in one call: depth as HxWxN, color as HxWx3xN.
+            % timestamps(i) is the timestamp of frame i
+            narginchk(3, 4);
+            validateattributes(n, {'numeric'}, {'scalar', 'positive', 'real', 'integer'}, '', 'n', 2);
+            validateattributes(stream, {'realsense.stream', 'numeric'}, {'scalar', 'nonnegative', 'real', 'integer', '<=', realsense.stream.count}, '', 'stream', 3);
+            if nargin == 3
+                [data, timestamps] = realsense.librealsense_mex(this.pipeline_ids.capture, this.objectHandle, uint64(n), int64(stream));
+            else
+                if isduration(timeout_ms)
+                    timeout_ms = milliseconds(timeout_ms);
+                end
+                validateattributes(timeout_ms, {'numeric'}, {'scalar', 'nonnegative', 'real', 'integer'}, '', 'timeout_ms', 4);
+                [data, timestamps] = realsense.librealsense_mex(this.pipeline_ids.capture, this.objectHandle, uint64(n), int64(stream), uint64(timeout_ms));
+            end
+        end
         % TODO: poll_for_frames
         function profile = get_active_profile(this)
-            out = realsense.librealsense_mex('rs2::pipeline', 'get_active_profile', this.objectHandle);
+            out = realsense.librealsense_mex(this.pipeline_ids.get_active_profile, this.objectHandle);
             realsense.pipeline_profile(out);
         end
     end
@@ -1,5 +1,8 @@
 % Wraps librealsense2 pointcloud class
 classdef pointcloud < realsense.options
+    properties (Constant, Hidden = true)
+        pointcloud_ids = realsense.librealsense_mex('librealsense_mex', 'method_ids', 'rs2::pointcloud');
+    end
     methods
         % Constructor
         function this = pointcloud()
@@ -16,13 +19,13 @@ classdef pointcloud < realsense.options
             if ~depth.is('depth_frame')
                 error('Expected input number 2, depth, to be a depth_frame');
             end
-            out = realsense.librealsense_mex('rs2::pointcloud', 'calculate', this.objectHandle, depth.objectHandle);
+            out = realsense.librealsense_mex(this.pointcloud_ids.calculate, this.objectHandle, depth.objectHandle);
             points = realsense.points(out);
         end
         function map_to(this, mapped)
             narginchk(2, 2)
             validateattributes(mapped, {'realsense.frame'}, {'scalar'}, '', 'mapped', 2);
-            realsense.librealsense_mex('rs2::pointcloud', 'map_to', this.objectHandle, mapped.objectHandle);
+            realsense.librealsense_mex(this.pointcloud_ids.map_to, this.objectHandle, mapped.objectHandle);
         end
     end
 end
\ No newline at end of file
@@ -1,5 +1,8 @@
 % Wraps librealsense2 points class
 classdef points < realsense.frame
+    properties (Constant, Hidden = true)
+        points_ids = realsense.librealsense_mex('librealsense_mex', 'method_ids', 'rs2::points');
+    end
     methods
         % Constructor
         function this = points(handle)
@@ -9,8 +12,19 @@ classdef points < realsense.frame
         % Destructor (uses base class destructor)
         
         % Functions
-        function vertices = get_vertices(this)
-            vertices = realsense.librealsense_mex('rs2::points', 'get_vertices', this.objectHandle);
+        function vertices = get_vertices(this, type, drop_zeros)
+            % type is 'double' (default) or 'single'. With drop_zeros, points without depth are left out
+            narginchk(1, 3);
+            if nargin == 1
+                vertices = realsense.librealsense_mex(this.points_ids.get_vertices, this.objectHandle);
+                return;
+            end
+            use_single = strcmp(validatestring(type, {'double', 'single'}, '', 'type', 2), 'single');
+            if nargin == 2
+                drop_zeros = false;
+            end
+            validateattributes(drop_zeros, {'logical', 'numeric'}, {'scalar'}, '', 'drop_zeros', 3);
+            vertices = realsense.librealsense_mex(this.points_ids.get_vertices, this.objectHandle, use_single, logical(drop_zeros));
         end
         function export_to_ply(this, fname, texture)
             narginchk(3, 3)
@@ -19,13 +33,24 @@ classdef points < realsense.frame
             if ~texture.is('video_frame')
                 error('Expected input number 3, texture, to be a video_frame');
             end
-            realsense.librealsense_mex('rs2::points', 'export_to_ply', this.objectHandle, fname, texture.objectHandle);
+            realsense.librealsense_mex(this.points_ids.export_to_ply, this.objectHandle, fname, texture.objectHandle);
         end
-        function texture_coordinates = get_texture_coordinates(this)
-            texture_coordinates = realsense.librealsense_mex('rs2::points', 'get_texture_coordinates', this.objectHandle);
+        function texture_coordinates = get_texture_coordinates(this, type, drop_zeros)
+            % Same arguments as get_vertices, the rows of both stay matched
+            narginchk(1, 3);
+            if nargin == 1
+                texture_coordinates = realsense.librealsense_mex(this.points_ids.get_texture_coordinates, this.objectHandle);
+                return;
+            end
+            use_single = strcmp(validatestring(type, {'double', 'single'}, '', 'type', 2), 'single');
+            if nargin == 2
+                drop_zeros = false;
+            end
+            validateattributes(drop_zeros, {'logical', 'numeric'}, {'scalar'}, '', 'drop_zeros', 3);
+            texture_coordinates = realsense.librealsense_mex(this.points_ids.get_texture_coordinates, this.objectHandle, use_single, logical(drop_zeros));
         end
         function s = size(this)
-            realsense.librealsense_mex('rs2::points', 'size', this.objectHandle);
+            realsense.librealsense_mex(this.points_ids.size, this.objectHandle);
         end
     end
 end
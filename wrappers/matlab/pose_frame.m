@@ -1,5 +1,8 @@
 % Wraps librealsense2 pose_frame class
 classdef pose_frame < realsense.frame
+    properties (Constant, Hidden = true)
+        pose_frame_ids = realsense.librealsense_mex('librealsense_mex', 'method_ids', 'rs2::pose_frame');
+    end
     methods
         % Constructor
         function this = pose_frame(handle)
@@ -10,7 +13,7 @@ classdef pose_frame < realsense.frame
         
         % Functions
         function pose_data = get_pose_data(this)
-            pose_data = realsense.librealsense_mex('rs2::pose_frame', 'get_pose_data', this.objectHandle);
+            pose_data = realsense.librealsense_mex(this.pose_frame_ids.get_pose_data, this.objectHandle);
         end
     end
 end
\ No newline at end of file
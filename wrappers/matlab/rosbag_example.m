@@ -31,13 +31,8 @@ function rosbag_example(filename)
     % Colorize depth frame
     color = colorizer.colorize(depth);
 
-    % Get actual data and convert into a format imshow can use
-    % (Color data arrives as [R, G, B, R, G, B, ...] vector)
-    data = color.get_data();
-    channels = vec2mat(data, 3);
-    img(:,:,1) = vec2mat(channels(:,1), color.get_width());
-    img(:,:,2) = vec2mat(channels(:,2), color.get_width());
-    img(:,:,3) = vec2mat(channels(:,3), color.get_width());
+    % Get actual data as a HxWx3 image imshow can use
+    img = color.get_data(true);
 
     % Display image
     imshow(img);
@@ -42,7 +42,7 @@ classdef stream_profile < handle
             validateattributes(index, {'numeric'}, {'scalar', 'nonnegative', 'real', 'integer'}, '', 'index', 3);
             validateattributes(fmt, {'realsense.format', 'numeric'}, {'scalar', 'nonnegative', 'real', 'integer', '<=', realsense.format.count}, '', 'fmt', 4);
             out = realsense.librealsense_mex('rs2::stream_profile', 'clone', this.objectHandle, int64(type), int64(index), int64(fmt));
-            realsense.stream_profile(out{:});
+            profile = realsense.stream_profile(out{:});
         end
         function value = is(this, type)
             narginchk(2, 2);
@@ -3,6 +3,9 @@ classdef syncer < handle
     properties (SetAccess = private, Hidden = true)
         objectHandle;
     end
+    properties (Constant, Hidden = true)
+        syncer_ids = realsense.librealsense_mex('librealsense_mex', 'method_ids', 'rs2::syncer');
+    end
     methods
         % Constructor
         function this = syncer(queue_size)
@@ -17,7 +20,7 @@ classdef syncer < handle
         % Destructor
         function delete(this)
             if (this.objectHandle ~= 0)
-                realsense.librealsense_mex('rs2::syncer', 'delete', this.objectHandle);
+                realsense.librealsense_mex(this.syncer_ids.delete, this.objectHandle);
             end
         end
         
@@ -25,13 +28,13 @@ classdef syncer < handle
         function frames = wait_for_frames(this, timeout_ms)
             narginchk(1, 2);
             if nargin == 1
-                out = realsense.librealsense_mex('rs2::syncer', 'wait_for_frames', this.objectHandle);
+                out = realsense.librealsense_mex(this.syncer_ids.wait_for_frames, this.objectHandle);
             else
                 if isduration(timeout_ms)
                     timeout_ms = milliseconds(timeout_ms);
                 end
                 validateattributes(timeout_ms, {'numeric'}, {'scalar', 'nonnegative', 'real', 'integer'}, '', 'timeout_ms', 2);
-                out = realsense.librealsense_mex('rs2::syncer', 'wait_for_frames', this.objectHandle, double(timeout_ms));
+                out = realsense.librealsense_mex(this.syncer_ids.wait_for_frames, this.objectHandle, double(timeout_ms));
             end
             frames = realsense.frameset(out);
         end
\ No newline at end of file
@@ -0,0 +1,178 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+
+#if defined(_M_X64) || defined(__SSE2__)
+#include <emmintrin.h>
+#define RS2_MATLAB_SSE2
+#endif
+
+// Matlab arrays are column-major while librealsense images are row-major with interleaved channels.
+// These kernels turn an image of h rows and w pixels of C channels into an h x w x C matlab array in
+// a single pass. The image is walked in square tiles small enough that both the rows being read and
+// the columns being written stay in the L1 cache.
+namespace transpose
+{
+    // pixels per side of a tile
+    const size_t tile = 32;
+
+    // channel_map[c] is the source channel written to plane c, or nullptr to keep the channel order.
+    // stride is the size in bytes of a source row.
+    template <typename T, int C>
+    void to_column_major(const void* src, size_t stride, size_t w, size_t h, T* dst, const int* channel_map = nullptr)
+    {
+        int map[C];
+        for (int c = 0; c < C; ++c) map[c] = channel_map ? channel_map[c] : c;
+        const size_t plane = w * h;
+        auto row = [&](size_t y) { return reinterpret_cast<const T*>(static_cast<const uint8_t*>(src) + y * stride); };
+
+        for (size_t y0 = 0; y0 < h; y0 += tile) {
+            const size_t y1 = std::min(y0 + tile, h);
+            for (size_t x0 = 0; x0 < w; x0 += tile) {
+                const size_t x1 = std::min(x0 + tile, w);
+                for (size_t x = x0; x < x1; ++x) {
+                    for (int c = 0; c < C; ++c) {
+                        T* out = dst + c * plane + x * h;
+                        for (size_t y = y0; y < y1; ++y) out[y] = row(y)[x * C + map[c]];
+                    }
+                }
+            }
+        }
+    }
+
+#ifdef RS2_MATLAB_SSE2
+    namespace detail
+    {
+        // transposes the 8x8 block of 16 bit values at (x, y)
+        inline void transpose_8x8_u16(const uint8_t* src, size_t stride, size_t x, size_t y, size_t h, uint16_t* dst)
+        {
+            __m128i r[8];
+            for (int i = 0; i < 8; ++i)
+                r[i] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + (y + i) * stride + x * sizeof(uint16_t)));
+
+            const __m128i t0 = _mm_unpacklo_epi16(r[0], r[1]), t1 = _mm_unpackhi_epi16(r[0], r[1]);
+            const __m128i t2 = _mm_unpacklo_epi16(r[2], r[3]), t3 = _mm_unpackhi_epi16(r[2], r[3]);
+            const __m128i t4 = _mm_unpacklo_epi16(r[4], r[5]), t5 = _mm_unpackhi_epi16(r[4], r[5]);
+            const __m128i t6 = _mm_unpacklo_epi16(r[6], r[7]), t7 = _mm_unpackhi_epi16(r[6], r[7]);
+
+            const __m128i u0 = _mm_unpacklo_epi32(t0, t2), u1 = _mm_unpackhi_epi32(t0, t2);
+            const __m128i u2 = _mm_unpacklo_epi32(t1, t3), u3 = _mm_unpackhi_epi32(t1, t3);
+            const __m128i u4 = _mm_unpacklo_epi32(t4, t6), u5 = _mm_unpackhi_epi32(t4, t6);
+            const __m128i u6 = _mm_unpacklo_epi32(t5, t7), u7 = _mm_unpackhi_epi32(t5, t7);
+
+            const __m128i cols[8] = {
+                _mm_unpacklo_epi64(u0, u4), _mm_unpackhi_epi64(u0, u4),
+                _mm_unpacklo_epi64(u1, u5), _mm_unpackhi_epi64(u1, u5),
+                _mm_unpacklo_epi64(u2, u6), _mm_unpackhi_epi64(u2, u6),
+                _mm_unpacklo_epi64(u3, u7), _mm_unpackhi_epi64(u3, u7)
+            };
+            for (int i = 0; i < 8; ++i)
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + (x + i) * h + y), cols[i]);
+        }
+    }
+
+    // Single channel 16 bit images (depth, Y16) are the most common case, they use 8x8 SSE2
+    // transposes inside each tile and fall back to scalar copies on the edges
+    template <>
+    inline void to_column_major<uint16_t, 1>(const void* src, size_t stride, size_t w, size_t h, uint16_t* dst, const int*)
+    {
+        auto bytes = static_cast<const uint8_t*>(src);
+        // the SSE path loads whole 16 byte rows of a block, so each row must start on a pixel
+        const bool aligned_rows = stride % sizeof(uint16_t) == 0;
+
+        for (size_t y0 = 0; y0 < h; y0 += tile) {
+            const size_t y1 = std::min(y0 + tile, h);
+            for (size_t x0 = 0; x0 < w; x0 += tile) {
+                const size_t x1 = std::min(x0 + tile, w);
+                const size_t xs = aligned_rows ? x0 + (x1 - x0) / 8 * 8 : x0;
+                const size_t ys = aligned_rows ? y0 + (y1 - y0) / 8 * 8 : y0;
+                for (size_t y = y0; y < ys; y += 8)
+                    for (size_t x = x0; x < xs; x += 8)
+                        detail::transpose_8x8_u16(bytes, stride, x, y, h, dst);
+                // right edge of the tile
+                for (size_t x = xs; x < x1; ++x)
+                    for (size_t y = y0; y < y1; ++y)
+                        dst[x * h + y] = reinterpret_cast<const uint16_t*>(bytes + y * stride)[x];
+                // bottom edge of the tile
+                for (size_t x = x0; x < xs; ++x)
+                    for (size_t y = ys; y < y1; ++y)
+                        dst[x * h + y] = reinterpret_cast<const uint16_t*>(bytes + y * stride)[x];
+            }
+        }
+    }
+#endif
+
+    // points per block of to_columns, the block's source stays in the L1 cache while its C columns are written
+    const size_t block = 1024;
+
+#ifdef RS2_MATLAB_SSE2
+    namespace detail
+    {
+        inline void store4(float* dst, __m128 v) { _mm_storeu_ps(dst, v); }
+        inline void store4(double* dst, __m128 v)
+        {
+            _mm_storeu_pd(dst, _mm_cvtps_pd(v));
+            _mm_storeu_pd(dst + 2, _mm_cvtps_pd(_mm_movehl_ps(v, v)));
+        }
+
+        // splits 4 interleaved points into one register per channel
+        template <int C> struct deinterleave4
+        {
+            static const bool supported = false;
+            static void apply(const float* src, __m128* out) {}
+        };
+        template <> struct deinterleave4<2>
+        {
+            static const bool supported = true;
+            static void apply(const float* src, __m128* out)
+            {
+                const __m128 a = _mm_loadu_ps(src), b = _mm_loadu_ps(src + 4);
+                out[0] = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+                out[1] = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+            }
+        };
+        template <> struct deinterleave4<3>
+        {
+            static const bool supported = true;
+            static void apply(const float* src, __m128* out)
+            {
+                // a = x0 y0 z0 x1, b = y1 z1 x2 y2, c = z2 x3 y3 z3
+                const __m128 a = _mm_loadu_ps(src), b = _mm_loadu_ps(src + 4), c = _mm_loadu_ps(src + 8);
+                const __m128 x23 = _mm_shuffle_ps(b, c, _MM_SHUFFLE(1, 0, 3, 2));
+                out[0] = _mm_shuffle_ps(a, x23, _MM_SHUFFLE(3, 0, 3, 0));
+                const __m128 y01 = _mm_shuffle_ps(a, b, _MM_SHUFFLE(0, 0, 2, 1));
+                const __m128 y23 = _mm_shuffle_ps(b, c, _MM_SHUFFLE(2, 2, 3, 3));
+                out[1] = _mm_shuffle_ps(y01, y23, _MM_SHUFFLE(2, 0, 2, 0));
+                const __m128 z01 = _mm_shuffle_ps(a, b, _MM_SHUFFLE(1, 1, 2, 2));
+                const __m128 z23 = _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 3, 0, 0));
+                out[2] = _mm_shuffle_ps(z01, z23, _MM_SHUFFLE(2, 0, 2, 0));
+            }
+        };
+    }
+#endif
+
+    // Turns n interleaved points of C floats (vertices, texture coordinates) into an n x C matlab matrix,
+    // one column per channel. If index is set, row i gets point index[i] and n is the size of index.
+    template <typename T, int C>
+    void to_columns(const float* src, size_t n, T* dst, const uint32_t* index = nullptr)
+    {
+        for (size_t b = 0; b < n; b += block) {
+            const size_t e = std::min(b + block, n);
+            size_t i = b;
+#ifdef RS2_MATLAB_SSE2
+            if (!index && detail::deinterleave4<C>::supported) {
+                for (; i + 4 <= e; i += 4) {
+                    __m128 v[C];
+                    detail::deinterleave4<C>::apply(src + i * C, v);
+                    for (int c = 0; c < C; ++c) detail::store4(dst + c * n + i, v[c]);
+                }
+            }
+#endif
+            for (int c = 0; c < C; ++c) {
+                T* out = dst + c * n;
+                for (size_t k = i; k < e; ++k) out[k] = T(src[(index ? index[k] : k) * C + c]);
+            }
+        }
+    }
+}
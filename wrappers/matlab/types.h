@@ -1,5 +1,7 @@
 #pragma once
 #include "librealsense2/rs.hpp"
+#include "transpose.h"
+#include "handles.h"
 #include <memory>
 #include <array>
 
@@ -155,18 +157,14 @@ template<typename T> struct MatlabParamParser::mx_wrapper_fns<T, typename std::e
     {
         auto cells = mxCreateCellMatrix(1, 2);
         auto handle_cell = mxCreateNumericMatrix(1, 1, mxUINT64_CLASS, mxREAL);
-        auto handle_ptr = static_cast<uint64_t*>(mxGetData(cells));
+        auto handle_ptr = static_cast<uint64_t*>(mxGetData(handle_cell));
         *handle_ptr = reinterpret_cast<uint64_t>(type_traits<T>::rs2_internal_t(val));
 
         auto own_cell = mxCreateNumericMatrix(1, 1, mxUINT64_CLASS, mxREAL);
-        auto own_ptr = static_cast<uint64_t*>(mxGetData(cells));
-        // if its cloned, give the wrapper ownership of the stream_profile
-        if (val.is_cloned())
-        {
-            mexLock();
-            *own_ptr = reinterpret_cast<uint64_t>(new std::shared_ptr<rs2_stream_profile>(val));
-        }
-        else *own_ptr = reinterpret_cast<uint64_t>(nullptr);
+        auto own_ptr = static_cast<uint64_t*>(mxGetData(own_cell));
+        // if its cloned, give the wrapper ownership of the stream_profile through the profile slab
+        if (val.is_cloned()) *own_ptr = slab<std::shared_ptr<rs2_stream_profile>>().add(std::shared_ptr<rs2_stream_profile>(val));
+        else *own_ptr = 0;
 
         mxSetCell(cells, 0, handle_cell);
         mxSetCell(cells, 1, own_cell);
@@ -174,40 +172,34 @@ template<typename T> struct MatlabParamParser::mx_wrapper_fns<T, typename std::e
     }
     static void destroy(const mxArray* cell)
     {
-        // we parse a std::shard_ptr<rs2_stream_profile>* because that is how the ownership
-        // pointer is stored, which is the one we need to destroy (assuming it exists)
-        auto ptr = mx_wrapper_fns<std::shared_ptr<rs2_stream_profile>*>::parse(cell);
-        if (!ptr) return; // only destroy if wrapper owns the profile
-        delete ptr;
-        mexUnlock();
+        // the ownership handle is an id in the profile slab, or 0 if the wrapper doesn't own the profile
+        auto id = mx_wrapper_fns<uint64_t>::parse(cell);
+        if (id) slab<std::shared_ptr<rs2_stream_profile>>().remove(id);
     }
 };
 
-// rs2::frame does its own internal refcounting, so this interfaces with it properly
+// Frames live in the frame slab (see handles.h) and matlab holds their id. The slab keeps one reference
+// to the frame, parsing rs2::frame itself hands out a reference to it without touching the refcount.
 template<typename T> struct MatlabParamParser::mx_wrapper_fns<T, typename std::enable_if<std::is_base_of<rs2::frame, T>::value>::type>
 {
+    using parse_t = typename std::conditional<std::is_same<T, rs2::frame>::value, const rs2::frame&, T>::type;
     static mxArray* wrap(T&& var)
     {
         using wrapper_t = mx_wrapper<T>;
         mxArray *cell = mxCreateNumericMatrix(1, 1, wrapper_t::value::value, mxREAL);
         auto *outp = static_cast<uint64_t*>(mxGetData(cell));
-        auto inptr = type_traits<T>::rs2_internal_t(var);
-        rs2_frame_add_ref(inptr, nullptr);
-        mexLock(); // Wrapper holds a reference to the internal type, which won't get destroyed until the wrapper lets go
-        *outp = reinterpret_cast<uint64_t>(inptr);
+        *outp = slab<rs2::frame>().add(rs2::frame(std::move(var)));
         return cell;
     }
-    static T parse(const mxArray* cell)
+    static parse_t parse(const mxArray* cell)
     {
-        auto inptr = mx_wrapper_fns<type_traits<T>::rs2_internal_t>::parse(cell);
-        rs2_frame_add_ref(inptr, nullptr);
-        return T(inptr);
+        auto f = slab<rs2::frame>().get(mx_wrapper_fns<uint64_t>::parse(cell));
+        if (!f) mexErrMsgTxt("Error parsing argument: the frame was deleted or the handle is invalid");
+        return parse_t(*f);
     }
     static void destroy(const mxArray* cell)
     {
-        auto inptr = mx_wrapper_fns<type_traits<T>::rs2_internal_t>::parse(cell);
-        rs2_release_frame(inptr);
-        mexUnlock(); // Wrapper holds a reference to the internal type, which won't get destroyed until the wrapper lets go
+        slab<rs2::frame>().remove(mx_wrapper_fns<uint64_t>::parse(cell));
     }
 };
 template <> static mxArray* MatlabParamParser::wrap_array<rs2::vertex>(const rs2::vertex* var, size_t length)
@@ -215,11 +207,7 @@ template <> static mxArray* MatlabParamParser::wrap_array<rs2::vertex>(const rs2
     using wrapper_t = mx_wrapper<float>;
     auto cells = mxCreateNumericMatrix(length, 3, wrapper_t::value::value, mxREAL);
     auto ptr = static_cast<typename wrapper_t::type*>(mxGetData(cells));
-    for (int x = 0; x < length; ++x) {
-        ptr[0 * length + x] = wrapper_t::type(var[x].x);
-        ptr[1 * length + x] = wrapper_t::type(var[x].y);
-        ptr[2 * length + x] = wrapper_t::type(var[x].z);
-    }
+    transpose::to_columns<wrapper_t::type, 3>(reinterpret_cast<const float*>(var), length, ptr);
     return cells;
 }
 template <> static mxArray* MatlabParamParser::wrap_array<rs2::texture_coordinate>(const rs2::texture_coordinate* var, size_t length)
@@ -227,10 +215,7 @@ template <> static mxArray* MatlabParamParser::wrap_array<rs2::texture_coordinat
     using wrapper_t = mx_wrapper<float>;
     auto cells = mxCreateNumericMatrix(length, 2, wrapper_t::value::value, mxREAL);
     auto ptr = static_cast<typename wrapper_t::type*>(mxGetData(cells));
-    for (int x = 0; x < length; ++x) {
-        ptr[0 * length + x] = wrapper_t::type(var[x].u);
-        ptr[1 * length + x] = wrapper_t::type(var[x].v);
-    }
+    transpose::to_columns<wrapper_t::type, 2>(reinterpret_cast<const float*>(var), length, ptr);
     return cells;
 }
 
@@ -1,5 +1,8 @@
 % Wraps librealsense2 video_frame class
 classdef video_frame < realsense.frame
+    properties (Constant, Hidden = true)
+        video_frame_ids = realsense.librealsense_mex('librealsense_mex', 'method_ids', 'rs2::video_frame');
+    end
     methods
         % Constructor
         function this = video_frame(handle)
@@ -10,19 +13,19 @@ classdef video_frame < realsense.frame
         
         % Functions
         function width = get_width(this)
-            width = realsense.librealsense_mex('rs2::video_frame', 'get_width', this.objectHandle);
+            width = realsense.librealsense_mex(this.video_frame_ids.get_width, this.objectHandle);
         end
         function height = get_height(this)
-            height = realsense.librealsense_mex('rs2::video_frame', 'get_height', this.objectHandle);
+            height = realsense.librealsense_mex(this.video_frame_ids.get_height, this.objectHandle);
         end
         function stride = get_stride_in_bytes(this)
-            stride = realsense.librealsense_mex('rs2::video_frame', 'get_stride_in_bytes', this.objectHandle);
+            stride = realsense.librealsense_mex(this.video_frame_ids.get_stride_in_bytes, this.objectHandle);
         end
         function bipp = get_bits_per_pixel(this)
-            bipp = realsense.librealsense_mex('rs2::video_frame', 'get_bits_per_pixel', this.objectHandle);
+            bipp = realsense.librealsense_mex(this.video_frame_ids.get_bits_per_pixel, this.objectHandle);
         end
         function bpp = get_bytes_per_pixel(this)
-            bpp = realsense.librealsense_mex('rs2::video_frame', 'get_bytes_per_pixel', this.objectHandle);
+            bpp = realsense.librealsense_mex(this.video_frame_ids.get_bytes_per_pixel, this.objectHandle);
         end
     end
 end
\ No newline at end of file
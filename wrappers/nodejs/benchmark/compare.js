@@ -0,0 +1,83 @@
+#!/usr/bin/env node
+
+// Copyright (c) 2018 Intel Corporation. All rights reserved.
+// Use of this source code is governed by an Apache 2.0 license
+// that can be found in the LICENSE file.
+
+'use strict';
+
+const fs = require('fs');
+
+const SCHEMA = 'node-librealsense-benchmark/1';
+
+function usage() {
+  console.log('Usage: node benchmark/compare.js <base.json> <head.json> [--threshold <percent>]\n' +
+      '  Exits with 1 if a figure of head is worse than base by more than threshold percent' +
+      ' (default 10)');
+}
+
+function load(file) {
+  const report = JSON.parse(fs.readFileSync(file, 'utf8'));
+  if (report.schema !== SCHEMA) {
+    throw new Error(file + ' is not a ' + SCHEMA + ' report');
+  }
+  return report;
+}
+
+function pad(text, width) {
+  text = String(text);
+  return text + ' '.repeat(Math.max(0, width - text.length));
+}
+
+function format(value) {
+  return (value === null || value === undefined) ? '-' : value.toFixed(3);
+}
+
+function main() {
+  const args = process.argv.slice(2);
+  let threshold = 10;
+  const files = [];
+  for (let i = 0; i < args.length; i++) {
+    if (args[i] === '--threshold') {
+      threshold = parseFloat(args[++i]);
+    } else {
+      files.push(args[i]);
+    }
+  }
+  if (files.length !== 2 || !(threshold >= 0)) {
+    usage();
+    process.exit(1);
+  }
+
+  const base = load(files[0]);
+  const head = load(files[1]);
+  if (base.file !== head.file || base.fileBytes !== head.fileBytes) {
+    console.warn('Warning: the reports were measured with different files');
+  }
+  console.log('base: ' + (base.label || base.commit) + '\nhead: ' + (head.label || head.commit));
+  console.log(pad('benchmark', 26) + pad('unit', 6) + pad('base', 12) + pad('head', 12) +
+      'worse by');
+
+  let regressions = 0;
+  Object.keys(base.results).forEach((name) => {
+    const b = base.results[name];
+    const h = head.results[name];
+    if (!h || !b.value || h.value === null) {
+      console.log(pad(name, 26) + pad(b.unit, 6) + pad(format(b.value), 12) + '-');
+      return;
+    }
+    // positive when head is worse
+    const change = (h.value - b.value) / b.value * 100 * (b.better === 'higher' ? -1 : 1);
+    const regressed = change > threshold;
+    if (regressed) regressions++;
+    console.log(pad(name, 26) + pad(b.unit, 6) + pad(format(b.value), 12) +
+        pad(format(h.value), 12) + change.toFixed(1) + '%' +
+        (regressed ? '  <-- REGRESSION' : ''));
+  });
+  if (regressions) {
+    console.log(regressions + ' regression(s) above ' + threshold + '%');
+    process.exit(1);
+  }
+}
+
+main();
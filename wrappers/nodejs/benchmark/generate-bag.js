@@ -0,0 +1,408 @@
+#!/usr/bin/env node
+
+// Copyright (c) 2018 Intel Corporation. All rights reserved.
+// Use of this source code is governed by an Apache 2.0 license
+// that can be found in the LICENSE file.
+
+'use strict';
+
+// Writes the benchmark file without a camera: a synthetic scene stored in the layout the
+// librealsense recorder uses, a rosbag 2.0 file with the topics of file format version 3.
+// The device has a depth sensor streaming Z16 and a color sensor streaming RGB8, with
+// pinhole intrinsics and the extrinsics between them, so that align and pointcloud work.
+// The content only depends on the options, so the same file is produced on every machine.
+
+const fs = require('fs');
+const path = require('path');
+
+const FILE_VERSION = 3;
+
+// Message types: md5sum and definition, as stored in the connection records. Readers
+// only accept a message whose md5sum matches the type they instantiate
+const HEADER_DEFINITION = '\n' +
+    '================================================================================\n' +
+    'MSG: std_msgs/Header\nuint32 seq\ntime stamp\nstring frame_id\n';
+const TYPES = {
+  'std_msgs/UInt32': {md5: '304a39449588c7f8ce2df6e8001c5fce', definition: 'uint32 data\n'},
+  'std_msgs/Float32': {md5: '73fcbf46b49191e672908e50842a83d4', definition: 'float32 data\n'},
+  'std_msgs/String': {md5: '992ce8a1687cec8c8bd883ec73ca41d1', definition: 'string data\n'},
+  'diagnostic_msgs/KeyValue': {
+    md5: 'cf57fdc6617a881a88c16e768132149c',
+    definition: 'string key\nstring value\n',
+  },
+  'realsense_msgs/StreamInfo': {
+    md5: '311d7e24eac31bb87271d041bf70ff7d',
+    definition: 'uint32 fps\nstring encoding\nbool is_recommended\n',
+  },
+  'geometry_msgs/Transform': {
+    md5: 'ac9eff44abf714214112b05d54a3cf9b',
+    definition: 'geometry_msgs/Vector3 translation\ngeometry_msgs/Quaternion rotation\n' +
+        '\n================================================================================\n' +
+        'MSG: geometry_msgs/Vector3\nfloat64 x\nfloat64 y\nfloat64 z\n' +
+        '\n================================================================================\n' +
+        'MSG: geometry_msgs/Quaternion\nfloat64 x\nfloat64 y\nfloat64 z\nfloat64 w\n',
+  },
+  'sensor_msgs/Image': {
+    md5: '060021388200f6f0f447d0fcd9c64743',
+    definition: 'std_msgs/Header header\nuint32 height\nuint32 width\nstring encoding\n' +
+        'uint8 is_bigendian\nuint32 step\nuint8[] data\n' + HEADER_DEFINITION,
+  },
+  'sensor_msgs/CameraInfo': {
+    md5: 'c9a58c1b0b154e0e6da7578cb991d214',
+    definition: 'std_msgs/Header header\nuint32 height\nuint32 width\n' +
+        'string distortion_model\nfloat64[] D\nfloat64[9] K\nfloat64[9] R\nfloat64[12] P\n' +
+        'uint32 binning_x\nuint32 binning_y\nsensor_msgs/RegionOfInterest roi\n' +
+        HEADER_DEFINITION +
+        '\n================================================================================\n' +
+        'MSG: sensor_msgs/RegionOfInterest\nuint32 x_offset\nuint32 y_offset\n' +
+        'uint32 height\nuint32 width\nbool do_rectify\n',
+  },
+};
+
+// Little endian serialization of ROS messages
+class Serializer {
+  constructor() {
+    this.parts = [];
+  }
+  uint8(v) {
+    const b = Buffer.alloc(1);
+    b.writeUInt8(v, 0);
+    this.parts.push(b);
+    return this;
+  }
+  uint32(v) {
+    const b = Buffer.alloc(4);
+    b.writeUInt32LE(v, 0);
+    this.parts.push(b);
+    return this;
+  }
+  float32(v) {
+    const b = Buffer.alloc(4);
+    b.writeFloatLE(v, 0);
+    this.parts.push(b);
+    return this;
+  }
+  float64s(values) {
+    const b = Buffer.alloc(8 * values.length);
+    values.forEach((v, i) => b.writeDoubleLE(v, 8 * i));
+    this.parts.push(b);
+    return this;
+  }
+  time(t) {
+    return this.uint32(t.sec).uint32(t.nsec);
+  }
+  string(s) {
+    const b = Buffer.from(s, 'utf8');
+    return this.uint32(b.length).bytes(b);
+  }
+  bytes(b) {
+    this.parts.push(b);
+    return this;
+  }
+  header(seq, stamp) {
+    return this.uint32(seq).time(stamp).string('');
+  }
+  buffer() {
+    return Buffer.concat(this.parts);
+  }
+}
+
+function timeFromNs(ns) {
+  return {sec: Math.floor(ns / 1e9), nsec: ns % 1e9};
+}
+
+// Record header: a sequence of length prefixed name=value fields
+function recordHeader(fields) {
+  return Buffer.concat(Object.keys(fields).map((name) => {
+    const value = fields[name];
+    const field = Buffer.concat([Buffer.from(name + '='), value]);
+    const length = Buffer.alloc(4);
+    length.writeUInt32LE(field.length, 0);
+    return Buffer.concat([length, field]);
+  }));
+}
+
+function record(fields, data) {
+  const header = recordHeader(fields);
+  const lengths = [Buffer.alloc(4), Buffer.alloc(4)];
+  lengths[0].writeUInt32LE(header.length, 0);
+  lengths[1].writeUInt32LE(data.length, 0);
+  return Buffer.concat([lengths[0], header, lengths[1], data]);
+}
+
+function u8(v) {
+  return Buffer.from([v]);
+}
+function u32(v) {
+  const b = Buffer.alloc(4);
+  b.writeUInt32LE(v, 0);
+  return b;
+}
+function u64(v) {
+  const b = Buffer.alloc(8);
+  b.writeUInt32LE(v % 0x100000000, 0);
+  b.writeUInt32LE(Math.floor(v / 0x100000000), 4);
+  return b;
+}
+function time64(t) {
+  return Buffer.concat([u32(t.sec), u32(t.nsec)]);
+}
+
+const OP_MESSAGE = 0x02;
+const OP_BAG_HEADER = 0x03;
+const OP_INDEX = 0x04;
+const OP_CHUNK = 0x05;
+const OP_CHUNK_INFO = 0x06;
+const OP_CONNECTION = 0x07;
+const BAG_HEADER_LENGTH = 4096;
+
+// Minimal rosbag 2.0 writer: uncompressed chunks, each followed by its index records, then the
+// connection and chunk info records that readers load when opening the file
+class BagWriter {
+  constructor(file) {
+    this.fd = fs.openSync(file, 'w');
+    this.position = 0;
+    this.connections = new Map();
+    this.chunkInfos = [];
+    this.chunk = null;
+    this.write(Buffer.from('#ROSBAG V2.0\n'));
+    this.headerPosition = this.position;
+    this.write(this.bagHeader(0));
+  }
+
+  write(buffer) {
+    fs.writeSync(this.fd, buffer);
+    this.position += buffer.length;
+  }
+
+  bagHeader(indexPosition) {
+    const fields = {
+      op: u8(OP_BAG_HEADER),
+      index_pos: u64(indexPosition),
+      conn_count: u32(this.connections.size),
+      chunk_count: u32(this.chunkInfos.length),
+    };
+    // padded to a fixed size, so that it can be rewritten in place when the file is closed
+    const padding = BAG_HEADER_LENGTH - 8 - recordHeader(fields).length;
+    return record(fields, Buffer.alloc(padding, ' '));
+  }
+
+  connectionRecord(connection) {
+    const type = TYPES[connection.type];
+    return record({op: u8(OP_CONNECTION), topic: Buffer.from(connection.topic),
+      conn: u32(connection.id)}, recordHeader({
+      topic: Buffer.from(connection.topic),
+      type: Buffer.from(connection.type),
+      md5sum: Buffer.from(type.md5),
+      message_definition: Buffer.from(type.definition),
+    }));
+  }
+
+  startChunk() {
+    this.chunk = {records: [], size: 0, messages: new Map(), start: null, end: null};
+  }
+
+  addToChunk(buffer) {
+    this.chunk.records.push(buffer);
+    this.chunk.size += buffer.length;
+  }
+
+  // Writes a message at |ns| nanoseconds of bag time into the current chunk
+  message(topic, type, ns, data) {
+    let connection = this.connections.get(topic);
+    if (!connection) {
+      connection = {id: this.connections.size, topic: topic, type: type};
+      this.connections.set(topic, connection);
+      this.addToChunk(this.connectionRecord(connection));
+    }
+    const t = timeFromNs(ns);
+    if (!this.chunk.messages.has(connection.id)) this.chunk.messages.set(connection.id, []);
+    this.chunk.messages.get(connection.id).push({time: t, offset: this.chunk.size});
+    if (this.chunk.start === null || ns < this.chunk.start) this.chunk.start = ns;
+    if (this.chunk.end === null || ns > this.chunk.end) this.chunk.end = ns;
+    this.addToChunk(record({op: u8(OP_MESSAGE), conn: u32(connection.id), time: time64(t)},
+        data));
+  }
+
+  endChunk() {
+    const chunk = this.chunk;
+    this.chunkInfos.push({position: this.position, chunk: chunk});
+    this.write(record({op: u8(OP_CHUNK), compression: Buffer.from('none'), size: u32(chunk.size)},
+        Buffer.concat(chunk.records)));
+    chunk.messages.forEach((entries, id) => {
+      this.write(record({op: u8(OP_INDEX), ver: u32(1), conn: u32(id), count: u32(entries.length)},
+          Buffer.concat(entries.map((e) => Buffer.concat([time64(e.time), u32(e.offset)])))));
+    });
+    this.chunk = null;
+  }
+
+  close() {
+    const indexPosition = this.position;
+    this.connections.forEach((connection) => this.write(this.connectionRecord(connection)));
+    this.chunkInfos.forEach((info) => {
+      const counts = [];
+      info.chunk.messages.forEach((entries, id) => counts.push(u32(id), u32(entries.length)));
+      this.write(record({
+        op: u8(OP_CHUNK_INFO),
+        ver: u32(1),
+        chunk_pos: u64(info.position),
+        start_time: time64(timeFromNs(info.chunk.start)),
+        end_time: time64(timeFromNs(info.chunk.end)),
+        count: u32(info.chunk.messages.size),
+      }, Buffer.concat(counts)));
+    });
+    fs.writeSync(this.fd, this.bagHeader(indexPosition), 0, BAG_HEADER_LENGTH,
+        this.headerPosition);
+    fs.closeSync(this.fd);
+  }
+}
+
+// Static information is written at the earliest time a bag can hold, like the recorder does
+const STATIC_TIME = 1;
+
+function keyValue(key, value) {
+  return new Serializer().string(key).string(value).buffer();
+}
+
+function cameraInfo(stream) {
+  const k = [stream.fx, 0, stream.ppx, 0, stream.fy, stream.ppy, 0, 0, 1];
+  const p = [stream.fx, 0, stream.ppx, 0, 0, stream.fy, stream.ppy, 0, 0, 0, 1, 0];
+  return new Serializer().header(0, {sec: 0, nsec: 0})
+      .uint32(stream.height).uint32(stream.width).string('None')
+      .uint32(5).float64s([0, 0, 0, 0, 0])
+      .float64s(k).float64s([1, 0, 0, 0, 1, 0, 0, 0, 1]).float64s(p)
+      .uint32(0).uint32(0)
+      .uint32(0).uint32(0).uint32(0).uint32(0).uint8(0)
+      .buffer();
+}
+
+// Depth: a tilted wall with a sphere in front of it that moves across the image, and no
+// depth in a band on the left, like the area only one imager of a stereo camera sees
+function depthImage(width, height, frame, frames, depthUnits) {
+  const data = Buffer.alloc(width * height * 2);
+  const cx = width * (0.25 + 0.5 * frame / Math.max(frames - 1, 1));
+  const cy = height / 2;
+  const radius = height / 5;
+  for (let y = 0; y < height; y++) {
+    for (let x = Math.floor(width / 16); x < width; x++) {
+      let z = 2.0 + 0.5 * (x / width) + 0.25 * (y / height);
+      const dx = x - cx;
+      const dy = y - cy;
+      const d2 = dx * dx + dy * dy;
+      if (d2 < radius * radius) {
+        // sphere of 0.3 m radius centered 1 m away
+        const r = 0.3 * Math.sqrt(1 - d2 / (radius * radius));
+        z = Math.min(z, 1.0 - r);
+      }
+      data.writeUInt16LE(Math.round(z / depthUnits), 2 * (y * width + x));
+    }
+  }
+  return data;
+}
+
+// Color: a gradient with a checkerboard square that moves with the sphere of the depth image
+function colorImage(width, height, frame, frames) {
+  const data = Buffer.alloc(width * height * 3);
+  const cx = width * (0.25 + 0.5 * frame / Math.max(frames - 1, 1));
+  const half = height / 5;
+  for (let y = 0; y < height; y++) {
+    for (let x = 0; x < width; x++) {
+      const i = 3 * (y * width + x);
+      if (Math.abs(x - cx) < half && Math.abs(y - height / 2) < half) {
+        const v = ((Math.floor(x / 16) + Math.floor(y / 16)) & 1) ? 230 : 25;
+        data[i] = data[i + 1] = data[i + 2] = v;
+      } else {
+        data[i] = Math.floor(255 * x / width);
+        data[i + 1] = Math.floor(255 * y / height);
+        data[i + 2] = 128;
+      }
+    }
+  }
+  return data;
+}
+
+function image(stream, seq, stamp, encoding, bpp, data) {
+  return new Serializer().header(seq, stamp).uint32(stream.height).uint32(stream.width)
+      .string(encoding).uint8(0).uint32(stream.width * bpp).uint32(data.length).bytes(data)
+      .buffer();
+}
+
+function transform(translation) {
+  return new Serializer().float64s(translation).float64s([0, 0, 0, 1]).buffer();
+}
+
+/**
+ * Writes a synthetic recording of a depth camera that librealsense can play back
+ * @param {String} file the .bag file to write
+ * @param {Object} [options] width, height, fps and frames of both streams,
+ * default 640x480 at 30 fps, 30 frames
+ */
+function generateBag(file, options) {
+  const opts = Object.assign({width: 640, height: 480, fps: 30, frames: 30}, options);
+  const depthUnits = 0.001;
+  const stream = {
+    width: opts.width,
+    height: opts.height,
+    fx: opts.width * 0.9,
+    fy: opts.width * 0.9,
+    ppx: opts.width / 2,
+    ppy: opts.height / 2,
+  };
+  const depthPrefix = '/device_0/sensor_0/Depth_0';
+  const colorPrefix = '/device_0/sensor_1/Color_0';
+
+  const dir = path.dirname(path.resolve(file));
+  if (!fs.existsSync(dir)) fs.mkdirSync(dir);
+  const bag = new BagWriter(file);
+  bag.startChunk();
+  bag.message('/file_version', 'std_msgs/UInt32', STATIC_TIME,
+      new Serializer().uint32(FILE_VERSION).buffer());
+  [['Name', 'Synthetic Benchmark Camera'], ['Serial Number', '000000000000'],
+    ['Firmware Version', '0.0.0.0']].forEach((info) => {
+    bag.message('/device_0/info', 'diagnostic_msgs/KeyValue', STATIC_TIME,
+        keyValue(info[0], info[1]));
+  });
+  bag.message('/device_0/sensor_0/info', 'diagnostic_msgs/KeyValue', STATIC_TIME,
+      keyValue('Name', 'Stereo Module'));
+  bag.message('/device_0/sensor_1/info', 'diagnostic_msgs/KeyValue', STATIC_TIME,
+      keyValue('Name', 'RGB Camera'));
+  bag.message('/device_0/sensor_0/option/Depth_Units/value', 'std_msgs/Float32', STATIC_TIME,
+      new Serializer().float32(depthUnits).buffer());
+  bag.message('/device_0/sensor_0/option/Depth_Units/description', 'std_msgs/String',
+      STATIC_TIME, new Serializer().string('Number of meters represented by a single depth unit')
+          .buffer());
+  [[depthPrefix, 'mono16', [0, 0, 0]], [colorPrefix, 'rgb8', [0.015, 0, 0]]].forEach((s) => {
+    bag.message(s[0] + '/info', 'realsense_msgs/StreamInfo', STATIC_TIME,
+        new Serializer().uint32(opts.fps).string(s[1]).uint8(1).buffer());
+    bag.message(s[0] + '/info/camera_info', 'sensor_msgs/CameraInfo', STATIC_TIME,
+        cameraInfo(stream));
+    bag.message(s[0] + '/tf/0', 'geometry_msgs/Transform', STATIC_TIME, transform(s[2]));
+  });
+  bag.endChunk();
+
+  // One chunk per frame, both streams carry the same frame number and timestamp
+  const periodNs = Math.round(1e9 / opts.fps);
+  for (let i = 0; i < opts.frames; i++) {
+    const ns = (i + 1) * periodNs;
+    const stamp = timeFromNs(ns);
+    bag.startChunk();
+    bag.message(depthPrefix + '/image/data', 'sensor_msgs/Image', ns, image(stream, i + 1, stamp,
+        'mono16', 2, depthImage(stream.width, stream.height, i, opts.frames, depthUnits)));
+    bag.message(colorPrefix + '/image/data', 'sensor_msgs/Image', ns, image(stream, i + 1, stamp,
+        'rgb8', 3, colorImage(stream.width, stream.height, i, opts.frames)));
+    bag.endChunk();
+  }
+  bag.close();
+}
+
+module.exports = generateBag;
+
+if (require.main === module) {
+  const file = process.argv[2];
+  if (!file) {
+    console.log('Usage: node benchmark/generate-bag.js <bag> [frames]');
+    process.exit(1);
+  }
+  generateBag(file, process.argv[3] ? {frames: parseInt(process.argv[3])} : {});
+  console.log('Wrote ' + file);
+}
@@ -0,0 +1,265 @@
+#!/usr/bin/env node
+
+// Copyright (c) 2018 Intel Corporation. All rights reserved.
+// Use of this source code is governed by an Apache 2.0 license
+// that can be found in the LICENSE file.
+
+'use strict';
+
+const fs = require('fs');
+const os = require('os');
+const path = require('path');
+const spawn = require('child_process').spawnSync;
+const generateBag = require('./generate-bag.js');
+let rs2;
+try {
+  rs2 = require('node-librealsense');
+} catch (e) {
+  rs2 = require('../index.js');
+}
+
+const SCHEMA = 'node-librealsense-benchmark/1';
+const DEFAULT_FILE = path.join(__dirname, 'data', 'benchmark.bag');
+
+function usage() {
+  console.log('Usage: node benchmark/run.js [options]\n' +
+      '  --file <bag>       recorded file to play, default ' + DEFAULT_FILE + ',\n' +
+      '                     generated when it doesn\'t exist\n' +
+      '  --frames <n>       frames measured by each benchmark, default 300\n' +
+      '  --output <json>    write the results to this file instead of stdout\n' +
+      '  --label <text>     free text stored with the results\n' +
+      '  --record <bag>     record the benchmark file from a connected camera and exit\n' +
+      '  --record-frames <n> frames to record, default 60');
+}
+
+function parseArgs(argv) {
+  const opts = {file: DEFAULT_FILE, frames: 300, recordFrames: 60};
+  for (let i = 0; i < argv.length; i++) {
+    const value = argv[i + 1];
+    switch (argv[i]) {
+      case '--file': opts.file = value; i++; break;
+      case '--frames': opts.frames = parseInt(value); i++; break;
+      case '--output': opts.output = value; i++; break;
+      case '--label': opts.label = value; i++; break;
+      case '--record': opts.record = value; i++; break;
+      case '--record-frames': opts.recordFrames = parseInt(value); i++; break;
+      default:
+        usage();
+        process.exit(argv[i] === '--help' ? 0 : 1);
+    }
+  }
+  if (!(opts.frames > 0) || !(opts.recordFrames > 0)) {
+    usage();
+    process.exit(1);
+  }
+  return opts;
+}
+
+function now() {
+  const t = process.hrtime();
+  return t[0] * 1e3 + t[1] / 1e6;
+}
+
+// Summary of a set of samples, |value| is the figure compared across runs
+function summarize(unit, better, samples, value) {
+  const sorted = samples.slice().sort((a, b) => a - b);
+  const n = sorted.length;
+  if (n === 0) return {unit: unit, better: better, samples: 0, value: null};
+  const mean = sorted.reduce((sum, v) => sum + v, 0) / n;
+  const percentile = (p) => sorted[Math.min(n - 1, Math.floor(p * n))];
+  return {
+    unit: unit,
+    better: better,
+    samples: n,
+    value: (value === undefined) ? percentile(0.5) : value,
+    mean: mean,
+    median: percentile(0.5),
+    p95: percentile(0.95),
+    min: sorted[0],
+    max: sorted[n - 1],
+  };
+}
+
+function timeIt(samples, fn) {
+  const t0 = now();
+  const result = fn();
+  samples.push(now() - t0);
+  return result;
+}
+
+function startPlayback(file) {
+  const pipeline = new rs2.Pipeline();
+  const config = new rs2.Config();
+  config.enableDeviceFromFile(file, true);
+  const profile = pipeline.start(config);
+  // play the file as fast as frames are consumed, so that the figures don't depend on the
+  // recording frame rate
+  const playback = rs2.PlaybackDevice.from(profile.getDevice());
+  if (playback) playback.isRealTime = false;
+  return {pipeline: pipeline, config: config};
+}
+
+function stopPlayback(playback) {
+  playback.pipeline.stop();
+  playback.pipeline.destroy();
+  playback.config.destroy();
+}
+
+function benchWaitForFrames(file, frames, results) {
+  const playback = startPlayback(file);
+  const samples = [];
+  const t0 = now();
+  for (let i = 0; i < frames; i++) {
+    if (!timeIt(samples, () => playback.pipeline.waitForFrames())) {
+      throw new Error('waitForFrames() timed out, is the file valid?');
+    }
+  }
+  const elapsed = now() - t0;
+  stopPlayback(playback);
+  results.waitForFrames = summarize('ms', 'lower', samples);
+  results.waitForFramesThroughput = summarize('fps', 'higher', [], frames * 1000 / elapsed);
+}
+
+function benchProcessing(file, frames, results) {
+  const playback = startPlayback(file);
+  const colorizer = new rs2.Colorizer();
+  const pointcloud = new rs2.PointCloud();
+  const align = new rs2.Align(rs2.stream.STREAM_COLOR);
+  const filters = {
+    decimation: new rs2.DecimationFilter(),
+    spatial: new rs2.SpatialFilter(),
+    temporal: new rs2.TemporalFilter(),
+    holeFilling: new rs2.HoleFillingFilter(),
+  };
+  const samples = {getData: [], calculate: [], getVertices: [], colorize: [], align: []};
+  Object.keys(filters).forEach((name) => samples[name] = []);
+
+  for (let i = 0; i < frames; i++) {
+    const frameSet = playback.pipeline.waitForFrames();
+    const depth = frameSet.depthFrame;
+    if (!depth) throw new Error('the benchmark file must contain a depth stream');
+    timeIt(samples.getData, () => depth.getData());
+    const points = timeIt(samples.calculate, () => pointcloud.calculate(depth));
+    timeIt(samples.getVertices, () => points.getVertices());
+    Object.keys(filters).forEach((name) => {
+      timeIt(samples[name], () => filters[name].process(depth));
+    });
+    timeIt(samples.colorize, () => colorizer.colorize(depth));
+    if (frameSet.colorFrame) timeIt(samples.align, () => align.process(frameSet));
+  }
+
+  results.getData = summarize('ms', 'lower', samples.getData);
+  results.pointcloudCalculate = summarize('ms', 'lower', samples.calculate);
+  results.getVertices = summarize('ms', 'lower', samples.getVertices);
+  Object.keys(filters).forEach((name) => {
+    results[name + 'Filter'] = summarize('ms', 'lower', samples[name]);
+    filters[name].destroy();
+  });
+  results.colorize = summarize('ms', 'lower', samples.colorize);
+  if (samples.align.length) results.align = summarize('ms', 'lower', samples.align);
+  colorizer.destroy();
+  pointcloud.destroy();
+  align.destroy();
+  stopPlayback(playback);
+}
+
+// Stream through Pipeline.createReadStream() while a timer measures how late the event loop
+// runs it, which is the latency added to every other callback of the application
+function benchEventLoopLag(file, frames, results) {
+  return new Promise((resolve, reject) => {
+    const interval = 5;
+    const playback = startPlayback(file);
+    const stream = playback.pipeline.createReadStream({highWaterMark: 2});
+    const lags = [];
+    let expected = now() + interval;
+    let timer = setTimeout(function sample() {
+      const t = now();
+      lags.push(Math.max(0, t - expected));
+      expected = t + interval;
+      timer = setTimeout(sample, interval);
+    }, interval);
+    let count = 0;
+    const t0 = now();
+    stream.on('error', reject);
+    stream.on('data', (frameSet) => {
+      frameSet.destroy();
+      if (++count < frames) return;
+      const elapsed = now() - t0;
+      clearTimeout(timer);
+      stream.destroy();
+      stopPlayback(playback);
+      results.streamThroughput = summarize('fps', 'higher', [], frames * 1000 / elapsed);
+      results.eventLoopLag = summarize('ms', 'lower', lags, summarize('', '', lags).p95);
+      resolve();
+    });
+  });
+}
+
+function record(file, frames) {
+  const pipeline = new rs2.Pipeline();
+  const config = new rs2.Config();
+  config.enableStream(rs2.stream.STREAM_DEPTH, -1, 640, 480, rs2.format.FORMAT_Z16, 30);
+  config.enableStream(rs2.stream.STREAM_COLOR, -1, 640, 480, rs2.format.FORMAT_RGB8, 30);
+  config.enableRecordToFile(file);
+  pipeline.start(config);
+  for (let i = 0; i < frames; i++) pipeline.waitForFrames();
+  pipeline.stop();
+  pipeline.destroy();
+  config.destroy();
+  console.log('Recorded ' + frames + ' frames to ' + file);
+}
+
+function gitCommit() {
+  const git = spawn('git', ['rev-parse', 'HEAD'], {cwd: __dirname});
+  return (git.status === 0) ? git.stdout.toString().trim() : null;
+}
+
+async function main() {
+  const opts = parseArgs(process.argv.slice(2));
+  if (opts.record) {
+    record(opts.record, opts.recordFrames);
+    rs2.cleanup();
+    return;
+  }
+  if (!fs.existsSync(opts.file)) {
+    if (opts.file !== DEFAULT_FILE) {
+      console.error(opts.file + ' not found');
+      process.exit(1);
+    }
+    // A synthetic recording, so that the benchmarks also run without a camera (eg in CI)
+    generateBag(opts.file);
+    console.error('Generated ' + opts.file);
+  }
+
+  const results = {};
+  benchWaitForFrames(opts.file, opts.frames, results);
+  benchProcessing(opts.file, opts.frames, results);
+  await benchEventLoopLag(opts.file, opts.frames, results);
+  rs2.cleanup();
+
+  const report = {
+    schema: SCHEMA,
+    label: opts.label || null,
+    commit: gitCommit(),
+    date: new Date().toISOString(),
+    node: process.version,
+    platform: os.platform() + '-' + os.arch(),
+    cpu: os.cpus()[0].model,
+    file: path.basename(opts.file),
+    fileBytes: fs.statSync(opts.file).size,
+    frames: opts.frames,
+    results: results,
+  };
+  const json = JSON.stringify(report, null, 2);
+  if (opts.output) {
+    fs.writeFileSync(opts.output, json + '\n');
+  } else {
+    console.log(json);
+  }
+}
+
+main().catch((e) => {
+  console.error(e);
+  rs2.cleanup();
+  process.exit(1);
+});
@@ -6,8 +6,10 @@
 
 const RS2 = require('bindings')('node_librealsense');
 const EventEmitter = require('events');
+const Readable = require('stream').Readable;
 const PNG = require('pngjs').PNG;
 const fs = require('fs');
+const {SharedFrameSlots, slotHeaderLayout, slotState} = require('./shared-frame-pool.js');
 
 /**
  * UnrecoverableError is the type of error that jeopardized the modue that restart
@@ -712,6 +714,8 @@ class Sensor extends Options {
     super(cxxSensor);
     this.cxxSensor = cxxSensor;
     this._events = new EventEmitter();
+    this.streamSession = 0;
+    this.readStream = undefined;
     if (autoDelete === true) {
       internal.addObject(this);
     }
@@ -791,6 +795,7 @@ class Sensor extends Options {
   * @return {undefined} No return value
   */
   close() {
+    this._internalEndReadStream();
     this.cxxSensor.close();
   }
 
@@ -801,6 +806,7 @@ class Sensor extends Options {
   */
   destroy() {
     this._events = null;
+    this._internalEndReadStream();
     if (this.cxxSensor) {
       this.cxxSensor.destroy();
       this.cxxSensor = undefined;
@@ -835,6 +841,7 @@ class Sensor extends Options {
   start(callback) {
     const funcName = 'Sensor.start()';
     checkArgumentLength(1, 1, arguments.length, funcName);
+    this._internalEndReadStream();
     if (arguments[0] instanceof Syncer) {
       this.cxxSensor.startWithSyncer(arguments[0].cxxSyncer, false, 0);
     } else {
@@ -877,11 +884,80 @@ class Sensor extends Options {
     }
   }
 
+  /**
+   * Start streaming into a readable stream of frames. The sensor must have been opened, the
+   * frames are delivered by the sensor into a native frame queue and fetched from it on a worker
+   * thread. Destroying the stream stops the sensor, and the stream ends when the sensor is
+   * stopped, closed, destroyed or started again.
+   *
+   * @param {FrameStreamOptions} [options]
+   * @return {FrameStream}
+   *
+   * @example <caption>Pipe depth frames into a transform</caption>
+   *  sensor.open(profile);
+   *  sensor.createReadStream({highWaterMark: 8, policy: 'drop'}).pipe(encoder);
+   */
+  createReadStream(options = {}) {
+    const funcName = 'Sensor.createReadStream()';
+    checkArgumentLength(0, 1, arguments.length, funcName);
+    checkArgumentType(arguments, 'object', 0, funcName);
+    const opts = checkFrameStreamOptions(options, funcName);
+    const queue = new RS2.RSFrameQueue();
+    queue.create(opts.queueSize);
+    this._internalEndReadStream();
+    this.cxxSensor.startWithFrameQueue(queue);
+    const sensor = this;
+    const session = ++this.streamSession;
+    const pool = opts.pool;
+    const target = pool ? new FrameStreamTarget(() => pool._internalAcquireCxxFrame(),
+        (cxxFrame) => pool._internalRecycleCxxFrame(cxxFrame)) : undefined;
+    let closed = false;
+    const stream = new FrameStream({
+      wait: (timeout, callback) => {
+        if (!target) return queue.waitForFrameAsync(timeout, callback);
+        queue.waitForFrameAsync(timeout, (err, cxxFrame) => {
+          target.end();
+          callback(err, cxxFrame);
+        }, target.begin());
+      },
+      wrap: (cxxFrame) => {
+        if (!target) return Frame._internalCreateFrame(cxxFrame);
+        return pool._internalWrapFrame(target.take());
+      },
+      // the sensor streams into this queue until it is stopped, closed or started again
+      isActive: () => sensor.cxxSensor !== undefined && sensor.streamSession === session,
+      close: () => {
+        if (closed) return;
+        closed = true;
+        if (sensor.readStream === stream) sensor.readStream = undefined;
+        if (sensor.cxxSensor && sensor.streamSession === session) {
+          sensor.streamSession++;
+          sensor.cxxSensor.stop();
+        }
+        // deferred natively until the pending wait returns
+        queue.destroy();
+        if (target) target.close();
+      },
+    }, opts);
+    this.readStream = stream;
+    return stream;
+  }
+
+  // Ends the stream created by createReadStream(), if any, because the sensor stops streaming
+  // into it
+  _internalEndReadStream() {
+    this.streamSession++;
+    const stream = this.readStream;
+    this.readStream = undefined;
+    if (stream) stream._internalEnd();
+  }
+
   /**
    * stop streaming
    * @return {undefined} No return value
    */
   stop() {
+    this._internalEndReadStream();
     if (this.cxxSensor) {
       this.cxxSensor.stop();
     }
@@ -1607,6 +1683,26 @@ class PlaybackDevice extends Device {
     checkArgumentType(arguments, 'number', 0, funcName);
     this.cxxDev.seek(time);
   }
+  /**
+   * Sets the playback to a specified time point of the played data, without blocking the event
+   * loop while the file is read
+   * @param {time} time the target time to seek to, unit is millisecond
+   * @return {Promise} resolved once the seek is done
+   */
+  seekAsync(time) {
+    const funcName = 'PlaybackDevice.seekAsync()';
+    checkArgumentLength(1, 1, arguments.length, funcName);
+    checkArgumentType(arguments, 'number', 0, funcName);
+    return new Promise((resolve, reject) => {
+      this.cxxDev.seekAsync(time, (err) => {
+        if (err) {
+          reject(err);
+        } else {
+          resolve();
+        }
+      });
+    });
+  }
   /**
    * Indicates if playback is in real time mode or non real time
    * In real time mode, playback will play the same way the file was recorded. If the application
@@ -1849,6 +1945,36 @@ class Align {
   }
 }
 
+// Slots of the header array filled by RSFrame.getSnapshot(), must be kept in
+// sync with RSFrame::SnapshotField in addon.cpp
+const frameSnapshotLayout = {
+  WIDTH: 0,
+  HEIGHT: 1,
+  STRIDE_IN_BYTES: 2,
+  BITS_PER_PIXEL: 3,
+  TIMESTAMP: 4,
+  TIMESTAMP_DOMAIN: 5,
+  FRAME_NUMBER: 6,
+  DATA_BYTE_LENGTH: 7,
+  FIELD_COUNT: 8,
+};
+
+/**
+ * Header fields and metadata values of a frame, retrieved in one native call
+ * @typedef {Object} FrameSnapshot
+ * @property {Integer} width - The width in pixels, 0 for non-video frames
+ * @property {Integer} height - The height in pixels, 0 for non-video frames
+ * @property {Integer} strideInBytes - The stride in bytes, 0 for non-video frames
+ * @property {Integer} bitsPerPixel - The number of bits per pixel, 0 for non-video frames
+ * @property {Integer} dataByteLength - The length of the frame data in bytes
+ * @property {Number} timestamp - The timestamp of the frame
+ * @property {Integer} timestampDomain - see {@link timestamp_domain} for avaiable values
+ * @property {Integer} frameNumber - The frame number
+ * @property {Float64Array} metadata - The metadata values indexed by {@link frame_metadata},
+ *  <code>NaN</code> for the metadata that is not supported by the frame
+ * @see [Frame.snapshot()]{@link Frame#snapshot}
+ */
+
 /**
  * This class resprents a picture frame
  *
@@ -1870,8 +1996,14 @@ class Align {
 class Frame {
   constructor(cxxFrame) {
     this.cxxFrame = cxxFrame || new RS2.RSFrame();
+    this.header = new Float64Array(frameSnapshotLayout.FIELD_COUNT);
+    this.headerValid = false;
     this.updateProfile();
     internal.addObject(this);
+    this._internalBindResetBuffer();
+  }
+
+  _internalBindResetBuffer() {
     // called from native to reset this.arrayBuffer and this.typedArray when the
     // underlying frame was replaced. The arrayBuffer and typedArray must be reset
     // to avoid deprecated data to be used.
@@ -1879,9 +2011,33 @@ class Frame {
     this.cxxFrame._internalResetBuffer = function() {
       jsWrapper.typedArray = undefined;
       jsWrapper.arrayBuffer = undefined;
+      jsWrapper.headerValid = false;
     };
   }
 
+  // Make this (pooled) frame wrap another native frame, the previous native wrapper is returned
+  // so that it can be filled again.
+  _internalAttach(cxxFrame) {
+    const old = this.cxxFrame;
+    old._internalResetBuffer = function() {};
+    this.cxxFrame = cxxFrame;
+    this._internalBindResetBuffer();
+    this.typedArray = undefined;
+    this.arrayBuffer = undefined;
+    this.headerValid = false;
+    this.updateProfile();
+    return old;
+  }
+
+  // Fetch all header fields with one native call and cache them until the
+  // underlying frame is released or replaced.
+  _internalGetHeader(field) {
+    if (!this.headerValid && this.cxxFrame) {
+      this.headerValid = this.cxxFrame.getSnapshot(this.header);
+    }
+    return this.headerValid ? this.header[field] : undefined;
+  }
+
   updateProfile() {
     this.streamProfile = undefined;
     if (this.cxxFrame) {
@@ -1892,17 +2048,28 @@ class Frame {
     }
   }
 
+  /**
+   * Release the native frame now instead of waiting for the garbage collector. A frame obtained
+   * from a {@link FramePool} goes back to its pool and may be handed out again.
+   * @return {undefined}
+   */
   release() {
     if (this.cxxFrame) this.cxxFrame.destroy();
     if (this.streamProfile) this.streamProfile.destroy();
     this.arrayBuffer = undefined;
     this.typedArray = undefined;
+    this.headerValid = false;
+    if (this.poolInUse) {
+      this.poolInUse = false;
+      this.pool._internalRecycleFrame(this);
+    }
   }
 
   /**
    * Destroy the frame and its resource
    */
   destroy() {
+    if (this.pool) this.pool._internalDetach(this);
     this.release();
     this.cxxFrame = undefined;
     this.StreamProfile = undefined;
@@ -1949,7 +2116,8 @@ class Frame {
    * @return {Integer}
    */
   get timestamp() {
-    return this.cxxFrame.getTimestamp();
+    const value = this._internalGetHeader(frameSnapshotLayout.TIMESTAMP);
+    return value !== undefined ? value : this.cxxFrame.getTimestamp();
   }
 
   /**
@@ -1961,7 +2129,8 @@ class Frame {
    * @return {Integer} see {@link timestamp_domain} for avaiable values
    */
   get timestampDomain() {
-    return this.cxxFrame.getTimestampDomain();
+    const value = this._internalGetHeader(frameSnapshotLayout.TIMESTAMP_DOMAIN);
+    return value !== undefined ? value : this.cxxFrame.getTimestampDomain();
   }
 
   /**
@@ -1995,7 +2164,41 @@ class Frame {
    * @return {Integer}
    */
   get frameNumber() {
-    return this.cxxFrame.getFrameNumber();
+    const value = this._internalGetHeader(frameSnapshotLayout.FRAME_NUMBER);
+    return value !== undefined ? value : this.cxxFrame.getFrameNumber();
+  }
+
+  /**
+   * Retrieve the frame header and the value of every frame metadata in a single native call.
+   * Pass the object returned by a previous call to reuse it and its metadata array, which
+   * avoids any allocation when this is done for every frame.
+   * @param {FrameSnapshot} [target] the object to be filled
+   * @return {FrameSnapshot|undefined} undefined if the frame is not valid
+   */
+  snapshot(target) {
+    const funcName = 'Frame.snapshot()';
+    checkArgumentLength(0, 1, arguments.length, funcName);
+    if (arguments.length === 1) {
+      checkArgumentType(arguments, 'object', 0, funcName);
+    }
+    let result = target || {};
+    if (!(result.metadata instanceof Float64Array) ||
+        result.metadata.length !== frame_metadata.FRAME_METADATA_COUNT) {
+      result.metadata = new Float64Array(frame_metadata.FRAME_METADATA_COUNT);
+    }
+    if (!this.cxxFrame || !this.cxxFrame.getSnapshot(this.header, result.metadata)) {
+      return undefined;
+    }
+    this.headerValid = true;
+    result.width = this.header[frameSnapshotLayout.WIDTH];
+    result.height = this.header[frameSnapshotLayout.HEIGHT];
+    result.strideInBytes = this.header[frameSnapshotLayout.STRIDE_IN_BYTES];
+    result.bitsPerPixel = this.header[frameSnapshotLayout.BITS_PER_PIXEL];
+    result.timestamp = this.header[frameSnapshotLayout.TIMESTAMP];
+    result.timestampDomain = this.header[frameSnapshotLayout.TIMESTAMP_DOMAIN];
+    result.frameNumber = this.header[frameSnapshotLayout.FRAME_NUMBER];
+    result.dataByteLength = this.header[frameSnapshotLayout.DATA_BYTE_LENGTH];
+    return result;
   }
 
   /**
@@ -2087,12 +2290,17 @@ class Frame {
 
   static _internalCreateFrame(cxxFrame) {
     if (!cxxFrame) return undefined;
-    if (cxxFrame.isPoseFrame()) return new PoseFrame(cxxFrame);
-    if (cxxFrame.isMotionFrame()) return new MotionFrame(cxxFrame);
-    if (cxxFrame.isDisparityFrame()) return new DisparityFrame(cxxFrame);
-    if (cxxFrame.isDepthFrame()) return new DepthFrame(cxxFrame);
-    if (cxxFrame.isVideoFrame()) return new VideoFrame(cxxFrame);
-    return new Frame(cxxFrame);
+    const FrameClass = Frame._internalFrameClass(cxxFrame);
+    return new FrameClass(cxxFrame);
+  }
+
+  static _internalFrameClass(cxxFrame) {
+    if (cxxFrame.isPoseFrame()) return PoseFrame;
+    if (cxxFrame.isMotionFrame()) return MotionFrame;
+    if (cxxFrame.isDisparityFrame()) return DisparityFrame;
+    if (cxxFrame.isDepthFrame()) return DepthFrame;
+    if (cxxFrame.isVideoFrame()) return VideoFrame;
+    return Frame;
   }
 }
 
@@ -2116,7 +2324,8 @@ class VideoFrame extends Frame {
    * @return {Integer}
    */
   get width() {
-    return this.cxxFrame.getWidth();
+    const value = this._internalGetHeader(frameSnapshotLayout.WIDTH);
+    return value !== undefined ? value : this.cxxFrame.getWidth();
   }
 
   /**
@@ -2124,7 +2333,8 @@ class VideoFrame extends Frame {
    * @return {Integer}
    */
   get height() {
-    return this.cxxFrame.getHeight();
+    const value = this._internalGetHeader(frameSnapshotLayout.HEIGHT);
+    return value !== undefined ? value : this.cxxFrame.getHeight();
   }
 
   /**
@@ -2140,7 +2350,8 @@ class VideoFrame extends Frame {
    * @return {Integer}
    */
   get strideInBytes() {
-    return this.cxxFrame.getStrideInBytes();
+    const value = this._internalGetHeader(frameSnapshotLayout.STRIDE_IN_BYTES);
+    return value !== undefined ? value : this.cxxFrame.getStrideInBytes();
   }
 
   /**
@@ -2148,7 +2359,8 @@ class VideoFrame extends Frame {
    * @return {Integer}
    */
   get bitsPerPixel() {
-    return this.cxxFrame.getBitsPerPixel();
+    const value = this._internalGetHeader(frameSnapshotLayout.BITS_PER_PIXEL);
+    return value !== undefined ? value : this.cxxFrame.getBitsPerPixel();
   }
 
   /**
@@ -2156,7 +2368,7 @@ class VideoFrame extends Frame {
    * @return {Integer}
    */
   get bytesPerPixel() {
-    return this.cxxFrame.getBitsPerPixel()/8;
+    return this.bitsPerPixel/8;
   }
 }
 
@@ -2255,6 +2467,37 @@ class Points extends Frame {
   }
 }
 
+/**
+ * Index of each value of a rectangle in the result of
+ * [DepthFrame.getRoiStatistics()]{@link DepthFrame#getRoiStatistics}, the values of rectangle
+ * <code>i</code> start at <code>i * roiStatisticsLayout.FIELD_COUNT</code>. Distances are in
+ * meters, they are <code>NaN</code> when the rectangle has no valid depth.
+ * Must be kept in sync with RSFrame::RoiField in addon.cpp
+ * @property {Integer} COUNT - Count of pixels with a valid depth
+ * @property {Integer} MIN - Min distance
+ * @property {Integer} MAX - Max distance
+ * @property {Integer} MEAN - Mean distance
+ * @property {Integer} MEDIAN - Median distance, with the precision of the depth units
+ * @property {Integer} FIELD_COUNT - Count of values of each rectangle
+ */
+const roiStatisticsLayout = {
+  COUNT: 0,
+  MIN: 1,
+  MAX: 2,
+  MEAN: 3,
+  MEDIAN: 4,
+  FIELD_COUNT: 5,
+};
+
+/**
+ * A rectangular region of a frame, in pixels
+ * @typedef {Object} Rect
+ * @property {Integer} x - The left coordinate
+ * @property {Integer} y - The top coordinate
+ * @property {Integer} width - The width
+ * @property {Integer} height - The height
+ */
+
 /**
  * This class represents depth stream
  */
@@ -2276,6 +2519,82 @@ class DepthFrame extends VideoFrame {
     checkArgumentType(arguments, 'number', 1, funcName);
     return this.cxxFrame.getDistance(x, y);
   }
+
+  /**
+   * Compute the count of valid pixels and the min, max, mean and median distance of each
+   * rectangle, in one native pass run off the main thread. The frame may be released before the
+   * returned promise is settled.
+   * @param {Rect[]|Int32Array} rects the rectangles, or an Int32Array of
+   *  <code>(x, y, width, height)</code> tuples to avoid a conversion. Rectangles are clipped to
+   *  the frame.
+   * @param {Float64Array} [result] the array to be filled, to avoid an allocation per call, see
+   *  {@link roiStatisticsLayout} for its layout
+   * @return {Promise<Float64Array>} result
+   *
+   * @example <caption>Check that a region is clear</caption>
+   *  depthFrame.getRoiStatistics([{x: 300, y: 220, width: 40, height: 40}]).then((stats) => {
+   *    if (stats[rs2.roiStatisticsLayout.MIN] < 0.5) console.log('obstacle');
+   *  });
+   */
+  getRoiStatistics(rects, result) {
+    const funcName = 'DepthFrame.getRoiStatistics()';
+    checkArgumentLength(1, 2, arguments.length, funcName);
+    checkArgumentType(arguments, 'object', 0, funcName);
+    let flat = rects;
+    if (!(rects instanceof Int32Array)) {
+      if (!Array.isArray(rects)) {
+        throw new TypeError(funcName + ' expects an Array of Rect or an Int32Array');
+      }
+      flat = new Int32Array(rects.length * 4);
+      rects.forEach((r, i) => {
+        flat.set([r.x, r.y, r.width, r.height], i * 4);
+      });
+    }
+    const size = Math.floor(flat.length / 4) * roiStatisticsLayout.FIELD_COUNT;
+    if (result === undefined) result = new Float64Array(size);
+    if (!(result instanceof Float64Array) || result.length < size) {
+      throw new TypeError(funcName + ' expects result to be a Float64Array of at least ' + size +
+          ' elements');
+    }
+    return new Promise((resolve, reject) => {
+      const started = this.cxxFrame && this.cxxFrame.getRoiStatisticsAsync(flat, result, (err) => {
+        if (err) {
+          reject(err);
+        } else {
+          resolve(result);
+        }
+      });
+      if (!started) reject(new TypeError(funcName + ' the frame has no valid depth data'));
+    });
+  }
+
+  /**
+   * Compute the 3D point of every pixel with the intrinsics of the stream, in one native pass run
+   * off the main thread. The frame may be released before the returned promise is settled.
+   * @param {Float32Array} [points] the array to be filled with <code>(x, y, z)</code> coordinates
+   *  in meters, <code>width * height * 3</code> elements at least, the points of pixels without
+   *  depth are set to 0. A new one is allocated if omitted.
+   * @return {Promise<Float32Array>} points
+   */
+  deproject(points) {
+    const funcName = 'DepthFrame.deproject()';
+    checkArgumentLength(0, 1, arguments.length, funcName);
+    const size = this.width * this.height * 3;
+    if (points === undefined) points = new Float32Array(size);
+    if (!(points instanceof Float32Array) || points.length < size) {
+      throw new TypeError(funcName + ' expects a Float32Array of at least ' + size + ' elements');
+    }
+    return new Promise((resolve, reject) => {
+      const started = this.cxxFrame && this.cxxFrame.deprojectAsync(points, (err) => {
+        if (err) {
+          reject(err);
+        } else {
+          resolve(points);
+        }
+      });
+      if (!started) reject(new TypeError(funcName + ' the frame has no valid depth data'));
+    });
+  }
 }
 
 /**
@@ -2475,7 +2794,7 @@ class FrameSet {
     }
 
     for (const [i, data] of this.cacheMetadata.entries()) {
-      if (data.stream !== stream) {
+      if (!data || data.stream !== stream) {
         continue;
       }
       if (!streamIndex || (streamIndex && streamIndex === data.streamIndex)) {
@@ -2508,6 +2827,9 @@ class FrameSet {
           this.cacheMetadata[idx].stream, streamIndex, frame.cxxFrame)) {
         this.cache[idx] = undefined;
         this.cacheMetadata[idx] = undefined;
+      } else if (this.pool) {
+        // the frame kept from a previous use of this pooled frameset had its profile released
+        frame.updateProfile();
       }
     }
     return this.cache[idx];
@@ -2541,13 +2863,24 @@ class FrameSet {
         f.release();
       }
     });
+    // a pooled frameset keeps its frame objects, they're refilled by the next use
+    if (this.pool) return;
     this.cache = [];
     this.cacheMetadata = [];
   }
 
+  /**
+   * Release the native frames now instead of waiting for the garbage collector. A frameset
+   * obtained from a {@link FramePool} goes back to its pool and may be handed out again.
+   * @return {undefined}
+   */
   release() {
     this.releaseCache();
     if (this.cxxFrameSet) this.cxxFrameSet.destroy();
+    if (this.poolInUse) {
+      this.poolInUse = false;
+      this.pool._internalRecycleFrameSet(this);
+    }
   }
 
   /**
@@ -2556,11 +2889,487 @@ class FrameSet {
    * @return {undefined}
    */
   destroy() {
+    if (this.pool) {
+      this.pool._internalDetach(this);
+      this.pool = undefined;
+    }
     this.release();
     this.cxxFrameSet = undefined;
   }
 }
 
+/**
+ * Statistics of a {@link FramePool}
+ * @typedef {Object} FramePoolStatistics
+ * @property {Integer} created - Count of frame and frameset objects created by the pool
+ * @property {Integer} reused - Count of times an object was handed out again instead of being
+ *  created
+ * @property {Integer} inUse - Count of objects handed out and not released yet
+ * @property {Integer} free - Count of released objects waiting to be reused
+ * @property {Integer} discarded - Count of released objects dropped because the pool was full
+ * @property {Integer} nativeFrameWrappers - Count of native frame wrappers, of the whole module,
+ *  not garbage collected yet
+ * @property {Integer} nativeFrameSetWrappers - Count of native frameset wrappers, of the whole
+ *  module, not garbage collected yet
+ * @property {Integer} gcCount - Count of garbage collections since the pool was created, only
+ *  counted when the pool was created with <code>trackGC</code>
+ * @property {Number} gcDuration - Total duration in milliseconds of these garbage collections
+ */
+
+/**
+ * A pool of {@link Frame} and {@link FrameSet} objects. Passed to
+ * [Pipeline.createReadStream()]{@link Pipeline#createReadStream} or
+ * [Sensor.createReadStream()]{@link Sensor#createReadStream}, the streamed objects are taken
+ * from the pool, and their <code>release()</code> method gives the native frames back to
+ * librealsense at once and the object back to the pool. At a steady frame rate no JS or native
+ * wrapper is created anymore, which keeps the garbage collector quiet.
+ *
+ * @example <caption>Stream without allocating a wrapper per frame</caption>
+ *  const pool = new rs2.FramePool({trackGC: true});
+ *  pipeline.createReadStream({pool: pool}).on('data', (frameSet) => {
+ *    draw(frameSet.depthFrame);
+ *    frameSet.release();
+ *  });
+ *  setInterval(() => console.log(pool.statistics), 1000);
+ */
+class FramePool {
+  /**
+   * @param {Object} [options]
+   * @param {Integer} [options.maxFree=8] - Max count of released objects of each class kept for
+   *  reuse
+   * @param {Boolean} [options.trackGC=false] - Count the garbage collections, using
+   *  <code>perf_hooks</code>
+   */
+  constructor(options = {}) {
+    const funcName = 'FramePool.constructor()';
+    checkArgumentLength(0, 1, arguments.length, funcName);
+    checkArgumentType(arguments, 'object', 0, funcName);
+    this.maxFree = 8;
+    if (options.maxFree !== undefined) {
+      if (!Number.isInteger(options.maxFree) || options.maxFree < 0) {
+        throw new TypeError(funcName + ' expects maxFree to be a non-negative integer');
+      }
+      this.maxFree = options.maxFree;
+    }
+    this.freeFrameSets = [];
+    // free frames by class, a frame can only be reused for a frame of the same kind
+    this.freeFrames = new Map();
+    // empty native frames to be filled by the next waits
+    this.spareCxxFrames = [];
+    this.created = 0;
+    this.reused = 0;
+    this.inUse = 0;
+    this.discarded = 0;
+    this.gcCount = 0;
+    this.gcDuration = 0;
+    this.gcObserver = undefined;
+    if (options.trackGC) {
+      const {PerformanceObserver} = require('perf_hooks');
+      this.gcObserver = new PerformanceObserver((list) => {
+        list.getEntries().forEach((entry) => {
+          this.gcCount++;
+          this.gcDuration += entry.duration;
+        });
+      });
+      this.gcObserver.observe({entryTypes: ['gc']});
+    }
+  }
+
+  /**
+   * Get the statistics of the pool
+   * @return {FramePoolStatistics}
+   */
+  get statistics() {
+    const native = RS2.getObjectStatistics();
+    let free = this.freeFrameSets.length;
+    this.freeFrames.forEach((list) => {
+      free += list.length;
+    });
+    return {
+      created: this.created,
+      reused: this.reused,
+      inUse: this.inUse,
+      free: free,
+      discarded: this.discarded,
+      nativeFrameWrappers: native.frameWrappers,
+      nativeFrameSetWrappers: native.frameSetWrappers,
+      gcCount: this.gcCount,
+      gcDuration: this.gcDuration,
+    };
+  }
+
+  /**
+   * Destroy the free objects of the pool and stop tracking the garbage collections, the objects
+   * still in use are destroyed when released
+   * @return {undefined}
+   */
+  destroy() {
+    if (this.gcObserver) {
+      this.gcObserver.disconnect();
+      this.gcObserver = undefined;
+    }
+    this.maxFree = 0;
+    const free = this.freeFrameSets;
+    this.freeFrames.forEach((list) => free.push(...list));
+    this.freeFrameSets = [];
+    this.freeFrames.clear();
+    this.spareCxxFrames = [];
+    free.forEach((obj) => obj.destroy());
+  }
+
+  _internalAcquireFrameSet() {
+    let frameSet = this.freeFrameSets.pop();
+    if (frameSet) {
+      this.reused++;
+    } else {
+      frameSet = new FrameSet();
+      frameSet.pool = this;
+      this.created++;
+    }
+    frameSet.poolInUse = true;
+    this.inUse++;
+    return frameSet;
+  }
+
+  _internalAcquireCxxFrame() {
+    let cxxFrame = this.spareCxxFrames.pop();
+    if (!cxxFrame) {
+      cxxFrame = new RS2.RSFrame();
+      cxxFrame._internalResetBuffer = function() {};
+    }
+    return cxxFrame;
+  }
+
+  _internalRecycleCxxFrame(cxxFrame) {
+    cxxFrame.destroy();
+    this.spareCxxFrames.push(cxxFrame);
+  }
+
+  // Wrap a native frame filled by a wait into a pooled frame of the matching class
+  _internalWrapFrame(cxxFrame) {
+    const FrameClass = Frame._internalFrameClass(cxxFrame);
+    const free = this.freeFrames.get(FrameClass);
+    let frame;
+    if (free && free.length) {
+      frame = free.pop();
+      this.spareCxxFrames.push(frame._internalAttach(cxxFrame));
+      this.reused++;
+    } else {
+      frame = new FrameClass(cxxFrame);
+      frame.pool = this;
+      this.created++;
+    }
+    frame.poolInUse = true;
+    this.inUse++;
+    return frame;
+  }
+
+  _internalRecycleFrameSet(frameSet) {
+    this.inUse--;
+    if (this.freeFrameSets.length < this.maxFree) {
+      this.freeFrameSets.push(frameSet);
+    } else {
+      this.discarded++;
+      frameSet.destroy();
+    }
+  }
+
+  _internalRecycleFrame(frame) {
+    this.inUse--;
+    let free = this.freeFrames.get(frame.constructor);
+    if (!free) {
+      free = [];
+      this.freeFrames.set(frame.constructor, free);
+    }
+    if (free.length < this.maxFree) {
+      free.push(frame);
+    } else {
+      this.discarded++;
+      frame.destroy();
+    }
+  }
+
+  // Called when a pooled object is destroyed by its user
+  _internalDetach(obj) {
+    obj.pool = undefined;
+    if (obj.poolInUse) {
+      obj.poolInUse = false;
+      this.inUse--;
+      return;
+    }
+    const free = (obj instanceof FrameSet) ?
+        this.freeFrameSets : this.freeFrames.get(obj.constructor);
+    const idx = free ? free.indexOf(obj) : -1;
+    if (idx >= 0) free.splice(idx, 1);
+  }
+}
+
+// The pooled object a stream source is waiting into. It's handed over to the consumer only once a
+// frame was delivered into it, and goes back to the pool when the stream is closed, but not while
+// a native wait may still fill it.
+class FrameStreamTarget {
+  constructor(acquire, recycle) {
+    this.acquire = acquire;
+    this.recycle = recycle;
+    this.current = undefined;
+    this.waiting = false;
+    this.closed = false;
+  }
+
+  begin() {
+    if (!this.current) this.current = this.acquire();
+    this.waiting = true;
+    return this.current;
+  }
+
+  end() {
+    this.waiting = false;
+    if (this.closed) this.close();
+  }
+
+  take() {
+    const obj = this.current;
+    this.current = undefined;
+    return obj;
+  }
+
+  close() {
+    this.closed = true;
+    if (!this.waiting && this.current) this.recycle(this.take());
+  }
+}
+
+/**
+ * Options used to create a {@link FrameStream}
+ * @typedef {Object} FrameStreamOptions
+ * @property {Integer} [highWaterMark=4] - Max count of frames buffered in the stream before it
+ *  stops fetching from native
+ * @property {String} [policy='pause'] - What to do when <code>highWaterMark</code> is reached:
+ *  <br><code>'pause'</code> stops fetching, the native frame queue then keeps the latest
+ *  <code>queueSize</code> frames and drops the older ones;
+ *  <br><code>'drop'</code> keeps fetching at the camera rate and drops the new frames until the
+ *  consumer catches up.
+ * @property {Integer} [queueSize=highWaterMark] - Capacity of the native frame queue, only used
+ *  by [Sensor.createReadStream()]{@link Sensor#createReadStream}
+ * @property {Integer} [timeout=1000] - Max time in milliseconds a native wait may block a
+ *  worker thread before it is retried
+ * @property {FramePool} [pool] - Take the streamed objects from this pool, they must then be
+ *  given back with their <code>release()</code> method
+ * @see [Pipeline.createReadStream()]{@link Pipeline#createReadStream}
+ * @see [Sensor.createReadStream()]{@link Sensor#createReadStream}
+ */
+
+function checkFrameStreamOptions(options, funcName) {
+  const result = {
+    highWaterMark: 4,
+    policy: 'pause',
+    timeout: 1000,
+  };
+  if (options.highWaterMark !== undefined) {
+    if (!Number.isInteger(options.highWaterMark) || options.highWaterMark < 1) {
+      throw new TypeError(funcName + ' expects highWaterMark to be a positive integer');
+    }
+    result.highWaterMark = options.highWaterMark;
+  }
+  if (options.policy !== undefined) {
+    if (options.policy !== 'pause' && options.policy !== 'drop') {
+      throw new TypeError(funcName + ' expects policy to be either \'pause\' or \'drop\'');
+    }
+    result.policy = options.policy;
+  }
+  if (options.timeout !== undefined) {
+    if (!Number.isInteger(options.timeout) || options.timeout < 1) {
+      throw new TypeError(funcName + ' expects timeout to be a positive integer');
+    }
+    result.timeout = options.timeout;
+  }
+  result.queueSize = result.highWaterMark;
+  if (options.queueSize !== undefined) {
+    if (!Number.isInteger(options.queueSize) || options.queueSize < 1) {
+      throw new TypeError(funcName + ' expects queueSize to be a positive integer');
+    }
+    result.queueSize = options.queueSize;
+  }
+  if (options.pool !== undefined) {
+    if (!(options.pool instanceof FramePool)) {
+      throw new TypeError(funcName + ' expects pool to be a FramePool');
+    }
+    result.pool = options.pool;
+  }
+  return result;
+}
+
+/**
+ * An object mode <code>Readable</code> stream of frames, created by
+ * [Pipeline.createReadStream()]{@link Pipeline#createReadStream} (chunks are {@link FrameSet}
+ * objects) or [Sensor.createReadStream()]{@link Sensor#createReadStream} (chunks are
+ * {@link Frame} objects).
+ * Frames are waited for on a worker thread and only while the stream has room for them, so the
+ * event loop is never blocked and a slow consumer applies backpressure instead of making frames
+ * pile up in memory. Each chunk owns its native frame, call its <code>destroy()</code> method
+ * (or <code>release()</code> when streaming from a {@link FramePool}) once done with it to
+ * return the frame to librealsense.
+ * The stream is also an async iterator: <code>for await (const frame of stream) {...}</code>
+ *
+ * @property {Integer} deliveredFrames - Count of frames pushed to the consumer
+ * @property {Integer} droppedFrames - Count of frames dropped because of the <code>'drop'</code>
+ *  policy
+ */
+class FrameStream extends Readable {
+  constructor(source, options) {
+    super({objectMode: true, highWaterMark: options.highWaterMark});
+    this.source = source;
+    this.policy = options.policy;
+    this.timeout = options.timeout;
+    this.waiting = false;
+    this.wanted = false;
+    this.stopped = false;
+    this.deliveredFrames = 0;
+    this.droppedFrames = 0;
+  }
+
+  _read() {
+    this.wanted = true;
+    this._internalFetch();
+  }
+
+  _destroy(err, callback) {
+    if (!this.stopped) {
+      this.stopped = true;
+      this.source.close();
+    }
+    callback(err);
+  }
+
+  // Ends the stream once its source stopped, a wait in progress is dropped when it returns
+  _internalEnd() {
+    if (this.stopped) return;
+    this.stopped = true;
+    this.source.close();
+    this.push(null);
+  }
+
+  _internalFetch() {
+    if (this.waiting || this.stopped) return;
+
+    this.waiting = true;
+    this.source.wait(this.timeout, (err, cxxObj) => {
+      this.waiting = false;
+      if (this.stopped) {
+        if (cxxObj) cxxObj.destroy();
+        return;
+      }
+      if (err) {
+        // Errors are expected once the source stopped, anything else is reported to the consumer
+        if (this.source.isActive()) {
+          this.destroy(err);
+        } else {
+          this._internalEnd();
+        }
+        return;
+      }
+      if (!cxxObj) {
+        // A timeout is expected while the camera is idle, give up only if the source is gone
+        if (!this.source.isActive()) {
+          this._internalEnd();
+          return;
+        }
+      } else if (this.wanted) {
+        this.deliveredFrames++;
+        this.wanted = this.push(this.source.wrap(cxxObj));
+      } else {
+        this.droppedFrames++;
+        cxxObj.destroy();
+      }
+      if (this.wanted || this.policy === 'drop') this._internalFetch();
+    });
+  }
+}
+
+/**
+ * A pool of <code>SharedArrayBuffer</code> backed slots used to hand frames over to
+ * <code>worker_threads</code>. A frame is copied once, natively, into a free slot; the workers
+ * then receive the slot index only, read the frame in place through a {@link SharedFrameSlots}
+ * created from [handles]{@link SharedFrameSlots#handles} and release the slot with
+ * <code>Atomics</code> when done.
+ *
+ * The pool never blocks the writer. When every slot is still held by a worker,
+ * [write()]{@link SharedFramePool#write} drops the frame and returns -1: waiting for a slot would
+ * block the event loop, and with it the camera callbacks, behind the slowest worker.
+ *
+ * @example <caption>Spread frames over a pool of workers</caption>
+ *  const pool = new rs2.SharedFramePool(8, 1280 * 720 * 3);
+ *  const worker = new Worker('analyze.js', {workerData: {handles: pool.handles}});
+ *  const slot = pool.write(frameSet.colorFrame);
+ *  if (slot >= 0) worker.postMessage(slot);
+ *
+ * @property {Integer} droppedFrames - Count of frames not written because no slot was free
+ */
+class SharedFramePool extends SharedFrameSlots {
+  /**
+   * @param {Integer} slotCount count of slots
+   * @param {Integer} slotByteLength size in bytes of each slot, must be large enough to hold the
+   * data of the frames written to the pool
+   */
+  constructor(slotCount, slotByteLength) {
+    const funcName = 'SharedFramePool.constructor()';
+    checkArgumentLength(2, 2, arguments.length, funcName);
+    checkArgumentType(arguments, 'integer', 0, funcName);
+    checkArgumentType(arguments, 'integer', 1, funcName);
+    super({
+      slotCount: slotCount,
+      slotByteLength: slotByteLength,
+      dataBuffer: new SharedArrayBuffer(slotCount * slotByteLength),
+      headerBuffer: new SharedArrayBuffer(
+          slotCount * slotHeaderLayout.FIELD_COUNT * Float64Array.BYTES_PER_ELEMENT),
+      stateBuffer: new SharedArrayBuffer(slotCount * Int32Array.BYTES_PER_ELEMENT),
+    });
+    this.nextSlot = 0;
+    this.droppedFrames = 0;
+  }
+
+  /**
+   * Copy a frame into a free slot
+   * @param {Frame} frame the frame to be written
+   * @return {Integer} the slot index, or -1 if all the slots are busy
+   */
+  write(frame) {
+    const funcName = 'SharedFramePool.write()';
+    checkArgumentLength(1, 1, arguments.length, funcName);
+    checkArgumentType(arguments, Frame, 0, funcName);
+    for (let i = 0; i < this.slotCount; i++) {
+      const slot = (this.nextSlot + i) % this.slotCount;
+      if (Atomics.compareExchange(this.states, slot, slotState.FREE, slotState.WRITING) !==
+          slotState.FREE) {
+        continue;
+      }
+      const length = frame.cxxFrame.writeDataToSharedBuffer(
+          this.dataBuffer, slot * this.slotByteLength, this.slotByteLength);
+      if (!length) {
+        Atomics.store(this.states, slot, slotState.FREE);
+        throw new TypeError(funcName + ' failed to write the frame, is the slot large enough?');
+      }
+      const h = this.headers.subarray(slot * slotHeaderLayout.FIELD_COUNT);
+      h[slotHeaderLayout.WIDTH] = frame._internalGetHeader(frameSnapshotLayout.WIDTH);
+      h[slotHeaderLayout.HEIGHT] = frame._internalGetHeader(frameSnapshotLayout.HEIGHT);
+      h[slotHeaderLayout.STRIDE_IN_BYTES] =
+          frame._internalGetHeader(frameSnapshotLayout.STRIDE_IN_BYTES);
+      h[slotHeaderLayout.BITS_PER_PIXEL] =
+          frame._internalGetHeader(frameSnapshotLayout.BITS_PER_PIXEL);
+      h[slotHeaderLayout.FORMAT] = frame.format;
+      h[slotHeaderLayout.STREAM_TYPE] = frame.streamType;
+      h[slotHeaderLayout.TIMESTAMP] = frame.timestamp;
+      h[slotHeaderLayout.FRAME_NUMBER] = frame.frameNumber;
+      h[slotHeaderLayout.DATA_BYTE_LENGTH] = length;
+      Atomics.store(this.states, slot, slotState.READY);
+      this.nextSlot = slot + 1;
+      return slot;
+    }
+    this.droppedFrames++;
+    return -1;
+  }
+}
+
 /**
  * This class provides a simple way to retrieve frame data
  */
@@ -2734,6 +3543,412 @@ class Pipeline {
 
     return new PipelineProfile(this.cxxPipeline.getActiveProfile());
   }
+
+  /**
+   * Create a readable stream of the framesets produced by the pipeline. The pipeline must be
+   * started, the stream ends when it is stopped or destroyed. Unlike
+   * [waitForFrames()]{@link Pipeline#waitForFrames}, the event loop is not blocked and every
+   * chunk is a distinct {@link FrameSet} that must be destroyed by the consumer.
+   *
+   * @param {FrameStreamOptions} [options]
+   * @return {FrameStream}
+   *
+   * @example <caption>Process framesets as they come, at the pace of the consumer</caption>
+   *  pipeline.start();
+   *  pipeline.createReadStream({highWaterMark: 2}).on('data', (frameSet) => {
+   *    console.log(frameSet.depthFrame.timestamp);
+   *    frameSet.destroy();
+   *  });
+   */
+  createReadStream(options = {}) {
+    const funcName = 'Pipeline.createReadStream()';
+    checkArgumentLength(0, 1, arguments.length, funcName);
+    checkArgumentType(arguments, 'object', 0, funcName);
+    const opts = checkFrameStreamOptions(options, funcName);
+    const pipeline = this;
+    const pool = opts.pool;
+    const target = pool ? new FrameStreamTarget(() => pool._internalAcquireFrameSet(),
+        (frameSet) => frameSet.release()) : undefined;
+    return new FrameStream({
+      wait: (timeout, callback) => {
+        if (!pipeline.cxxPipeline) return callback(new Error('pipeline destroyed'));
+        if (!target) return pipeline.cxxPipeline.waitForFramesAsync(timeout, callback);
+        pipeline.cxxPipeline.waitForFramesAsync(timeout, (err, cxxFrameSet) => {
+          target.end();
+          callback(err, cxxFrameSet);
+        }, target.begin().cxxFrameSet);
+      },
+      wrap: (cxxFrameSet) => {
+        if (!target) return new FrameSet(cxxFrameSet);
+        const frameSet = target.take();
+        frameSet.__update();
+        return frameSet;
+      },
+      isActive: () => (pipeline.started === true && pipeline.cxxPipeline !== undefined),
+      close: () => {
+        if (target) target.close();
+      },
+    }, opts);
+  }
+}
+
+/**
+ * Statistics of a {@link PlaybackReader}
+ * @typedef {Object} PlaybackReaderStatistics
+ * @property {Integer} framesRead - Count of framesets read from the file
+ * @property {Integer} framesDelivered - Count of framesets returned by
+ *  [next()]{@link PlaybackReader#next}
+ * @property {Integer} framesDropped - Count of prefetched framesets dropped by a seek
+ * @property {Integer} queued - Count of framesets prefetched and not delivered yet
+ * @property {Integer} maxQueued - Max count of framesets prefetched at once
+ * @property {Float} throughput - Framesets read per second since the reader was created
+ * @property {Float} waitTimeMean - Mean time in milliseconds the native thread waited in
+ *  <code>try_wait_for_frames()</code> until a frameset was available, leaving out the time it was
+ *  blocked on a full queue and the polls at the end of the file. This is not the decode time:
+ *  librealsense reads and decodes the file on its own playback thread and doesn't report how long
+ *  that takes, framesets it decoded ahead are available without waiting
+ * @property {Float} waitTimeMax - Max of the same
+ * @property {Float} elapsed - Time in milliseconds since the reader was created
+ * @property {Boolean} finished - Whether the end of the file was reached
+ */
+
+/**
+ * Read a recorded file as fast as possible, for offline processing. The file is played in non
+ * real time mode, so no frame is dropped, and a native thread reads and decodes framesets ahead of
+ * the consumer while the event loop keeps running.
+ *
+ * @example <caption>Reprocess a recording</caption>
+ *  const reader = new rs2.PlaybackReader('record.bag', {prefetch: 32});
+ *  for await (const frameSet of reader) {
+ *    process(frameSet.depthFrame);
+ *    frameSet.destroy();
+ *  }
+ *  console.log(reader.statistics.throughput);
+ *  reader.destroy();
+ */
+class PlaybackReader {
+  /**
+   * @param {String} fileName the recorded file
+   * @param {Object} [options]
+   * @param {Integer} [options.prefetch=16] - Max count of framesets read ahead
+   * @param {Config} [options.config] - The streams to read, all the recorded streams by default
+   * @param {Context} [options.context] - The context to use, a new one by default
+   * @param {FramePool} [options.pool] - Take the returned framesets from this pool, they must then
+   *  be given back with their <code>release()</code> method
+   * @param {Integer} [options.timeout=1000] - Max time in milliseconds a native wait may block a
+   *  worker thread before it is retried
+   */
+  constructor(fileName, options = {}) {
+    const funcName = 'PlaybackReader.constructor()';
+    checkArgumentLength(1, 2, arguments.length, funcName);
+    checkArgumentType(arguments, 'string', 0, funcName);
+    checkArgumentType(arguments, 'object', 1, funcName);
+    checkFileExistence(fileName);
+    const prefetch = (options.prefetch === undefined) ? 16 : options.prefetch;
+    if (!Number.isInteger(prefetch) || prefetch < 1) {
+      throw new TypeError(funcName + ' expects prefetch to be a positive integer');
+    }
+    if (options.config !== undefined && !(options.config instanceof Config)) {
+      throw new TypeError(funcName + ' expects config to be a Config');
+    }
+    if (options.context !== undefined && !(options.context instanceof Context)) {
+      throw new TypeError(funcName + ' expects context to be a Context');
+    }
+    if (options.pool !== undefined && !(options.pool instanceof FramePool)) {
+      throw new TypeError(funcName + ' expects pool to be a FramePool');
+    }
+    this.timeout = (options.timeout === undefined) ? 1000 : options.timeout;
+    if (!Number.isInteger(this.timeout) || this.timeout < 1) {
+      throw new TypeError(funcName + ' expects timeout to be a positive integer');
+    }
+    this.pool = options.pool;
+    this.ownCtx = (options.context === undefined);
+    this.ctx = this.ownCtx ? new Context() : options.context;
+    this.ownConfig = (options.config === undefined);
+    this.config = this.ownConfig ? new Config() : options.config;
+    this.config.enableDeviceFromFile(fileName, false);
+    this.cxxPrefetcher = new RS2.RSPlaybackPrefetcher();
+    this.cxxPrefetcher.create(this.ctx.cxxCtx, this.config.cxxConfig, prefetch);
+    internal.addObject(this);
+  }
+
+  /**
+   * Get the next frameset of the file
+   * @return {Promise<FrameSet|undefined>} resolved with undefined at the end of the file
+   */
+  next() {
+    const frameSet = this.pool ? this.pool._internalAcquireFrameSet() : undefined;
+    return new Promise((resolve, reject) => {
+      const finish = (err, result) => {
+        if (frameSet && result !== frameSet) frameSet.release();
+        if (err) {
+          reject(err);
+        } else {
+          resolve(result);
+        }
+      };
+      const wait = () => {
+        if (!this.cxxPrefetcher) return finish(null, undefined);
+        this.cxxPrefetcher.nextAsync(this.timeout, (err, cxxFrameSet, ended) => {
+          if (err) return finish(err);
+          if (cxxFrameSet) {
+            if (!frameSet) return finish(null, new FrameSet(cxxFrameSet));
+            frameSet.__update();
+            return finish(null, frameSet);
+          }
+          if (ended) return finish(null, undefined);
+          wait();
+        }, frameSet ? frameSet.cxxFrameSet : undefined);
+      };
+      wait();
+    });
+  }
+
+  [Symbol.asyncIterator]() {
+    return {
+      next: () => this.next().then((frameSet) => {
+        return {value: frameSet, done: frameSet === undefined};
+      }),
+    };
+  }
+
+  /**
+   * Move the playback to a time point of the file, the framesets read ahead are dropped. The
+   * reading starts again if the end of the file was reached. Seeks that aren't awaited run one
+   * after the other
+   * @param {Integer} time the target time, unit is millisecond
+   * @return {Promise} resolved once the seek is done
+   */
+  seek(time) {
+    const funcName = 'PlaybackReader.seek()';
+    checkArgumentLength(1, 1, arguments.length, funcName);
+    checkArgumentType(arguments, 'number', 0, funcName);
+    return new Promise((resolve, reject) => {
+      if (!this.cxxPrefetcher) return reject(new Error(funcName + ' the reader is destroyed'));
+      this.cxxPrefetcher.seekAsync(time, (err) => {
+        if (err) {
+          reject(err);
+        } else {
+          resolve();
+        }
+      });
+    });
+  }
+
+  /**
+   * Get the statistics of the reader
+   * @return {PlaybackReaderStatistics|undefined}
+   */
+  get statistics() {
+    if (!this.cxxPrefetcher) return undefined;
+    const stats = this.cxxPrefetcher.getStatistics();
+    if (!stats) return undefined;
+    stats.throughput = stats.elapsed ? stats.framesRead * 1000 / stats.elapsed : 0;
+    stats.waitTimeMean = stats.framesRead ? stats.waitTimeTotal / stats.framesRead : 0;
+    delete stats.waitTimeTotal;
+    return stats;
+  }
+
+  /**
+   * Stop reading and release the resources, the native thread stops once the pending
+   * [next()]{@link PlaybackReader#next} calls return
+   * @return {undefined}
+   */
+  destroy() {
+    if (this.cxxPrefetcher) {
+      this.cxxPrefetcher.destroy();
+      this.cxxPrefetcher = undefined;
+    }
+    if (this.ownConfig && this.config) this.config.destroy();
+    this.config = undefined;
+    if (this.ownCtx && this.ctx) this.ctx.destroy();
+    this.ctx = undefined;
+  }
+}
+
+/**
+ * Framesets captured at the same time by the devices of a {@link MultiDeviceCapture}
+ * @typedef {Object} FrameGroup
+ * @property {FrameSet[]} frameSets - A frameset per device, in the order the devices were given.
+ *  They must be destroyed by the consumer.
+ * @property {Float} timestamp - The timestamp of the oldest frameset of the group, in
+ *  milliseconds
+ */
+
+/**
+ * Statistics of a {@link MultiDeviceCapture}
+ * @typedef {Object} MultiDeviceCaptureStatistics
+ * @property {Integer} groups - Count of groups delivered
+ * @property {Object[]} devices - Statistics of each device, in the order the devices were given
+ * @property {Integer} devices[].received - Count of framesets received from the device
+ * @property {Integer} devices[].dropped - Count of framesets dropped, because no frameset of the
+ *  other devices matched them or because the consumer was too slow
+ * @property {Integer} devices[].queued - Count of framesets waiting to be grouped
+ * @property {Float} devices[].skewMean - Mean time in milliseconds the frameset of the device was
+ *  behind the oldest one of its groups
+ * @property {Float} devices[].skewMax - Max of the same
+ */
+
+/**
+ * Capture from several devices at once. A pipeline is started for each device and waited for on
+ * a native thread, the framesets whose timestamps are within <code>tolerance</code> of each other
+ * are grouped and delivered together, the others are dropped.
+ * Frame timestamps can only be compared if the devices share a clock (hardware sync, global time
+ * domain); otherwise set <code>timestampSource</code> to <code>'arrival'</code> to group by host
+ * arrival time.
+ *
+ * @example <caption>Capture from all the connected cameras</caption>
+ *  const serials = ctx.queryDevices().devices.map((d) => d.getCameraInfo().serialNumber);
+ *  const capture = new rs2.MultiDeviceCapture(serials, {tolerance: 20});
+ *  for await (const group of capture) {
+ *    group.frameSets.forEach((frameSet) => frameSet.destroy());
+ *  }
+ */
+class MultiDeviceCapture {
+  /**
+   * @param {Array<String|Config>} devices the serial numbers of the devices, or a {@link Config}
+   *  per device to select their streams
+   * @param {Object} [options]
+   * @param {Float} [options.tolerance=15] - Max time in milliseconds between the framesets of a
+   *  group
+   * @param {Integer} [options.queueSize=4] - Count of framesets of each device kept while waiting
+   *  for the other devices, the oldest is dropped when the consumer is too slow
+   * @param {String} [options.timestampSource='frame'] - <code>'frame'</code> to group by frame
+   *  timestamps, <code>'arrival'</code> to group by host arrival time
+   * @param {Context} [options.context] - The context to use, a new one by default
+   * @param {Integer} [options.timeout=1000] - Max time in milliseconds a native wait may block a
+   *  worker thread before it is retried
+   */
+  constructor(devices, options = {}) {
+    const funcName = 'MultiDeviceCapture.constructor()';
+    checkArgumentLength(1, 2, arguments.length, funcName);
+    checkArgumentType(arguments, 'object', 0, funcName);
+    checkArgumentType(arguments, 'object', 1, funcName);
+    if (!Array.isArray(devices) || devices.length === 0) {
+      throw new TypeError(funcName + ' expects a non empty Array of serial numbers or Config');
+    }
+    const tolerance = (options.tolerance === undefined) ? 15 : options.tolerance;
+    if (typeof tolerance !== 'number' || !(tolerance >= 0)) {
+      throw new TypeError(funcName + ' expects tolerance to be a non-negative number');
+    }
+    const queueSize = (options.queueSize === undefined) ? 4 : options.queueSize;
+    if (!Number.isInteger(queueSize) || queueSize < 1) {
+      throw new TypeError(funcName + ' expects queueSize to be a positive integer');
+    }
+    const source = (options.timestampSource === undefined) ? 'frame' : options.timestampSource;
+    if (source !== 'frame' && source !== 'arrival') {
+      throw new TypeError(funcName + ' expects timestampSource to be either \'frame\' or ' +
+          '\'arrival\'');
+    }
+    if (options.context !== undefined && !(options.context instanceof Context)) {
+      throw new TypeError(funcName + ' expects context to be a Context');
+    }
+    this.timeout = (options.timeout === undefined) ? 1000 : options.timeout;
+    if (!Number.isInteger(this.timeout) || this.timeout < 1) {
+      throw new TypeError(funcName + ' expects timeout to be a positive integer');
+    }
+    this.ownConfigs = [];
+    this.ownCtx = (options.context === undefined);
+    // The native create throws on a librealsense error, release what is owned before rethrowing
+    try {
+      const configs = devices.map((device) => {
+        if (device instanceof Config) return device;
+        if (typeof device !== 'string') {
+          throw new TypeError(funcName + ' expects a non empty Array of serial numbers or Config');
+        }
+        const config = new Config();
+        config.enableDevice(device);
+        this.ownConfigs.push(config);
+        return config;
+      });
+      this.ctx = this.ownCtx ? new Context() : options.context;
+      this.cxxCapture = new RS2.RSMultiDeviceCapture();
+      if (!this.cxxCapture.create(this.ctx.cxxCtx, configs.map((c) => c.cxxConfig), tolerance,
+          queueSize, source === 'arrival')) {
+        throw new Error(funcName + ' failed to start the devices');
+      }
+    } catch (err) {
+      this.destroy();
+      throw err;
+    }
+    internal.addObject(this);
+  }
+
+  /**
+   * Get the next group of framesets
+   * @return {Promise<FrameGroup|undefined>} resolved with undefined once the capture is destroyed
+   */
+  next() {
+    return new Promise((resolve, reject) => {
+      const wait = () => {
+        if (!this.cxxCapture) return resolve(undefined);
+        this.cxxCapture.nextAsync(this.timeout, (err, cxxFrameSets, timestamp) => {
+          if (err) return reject(err);
+          if (!cxxFrameSets) return wait();
+          resolve({
+            frameSets: cxxFrameSets.map((cxxFrameSet) => new FrameSet(cxxFrameSet)),
+            timestamp: timestamp,
+          });
+        });
+      };
+      wait();
+    });
+  }
+
+  [Symbol.asyncIterator]() {
+    return {
+      next: () => this.next().then((group) => {
+        return {value: group, done: group === undefined};
+      }),
+    };
+  }
+
+  /**
+   * This callback is called with each group of framesets
+   * @callback FrameGroupCallback
+   * @param {FrameGroup} group
+   */
+
+  /**
+   * Deliver the groups to a callback as they come
+   * @param {FrameGroupCallback} callback
+   * @return {Promise} resolved once the capture is destroyed, rejected if the capture fails
+   */
+  start(callback) {
+    const funcName = 'MultiDeviceCapture.start()';
+    checkArgumentLength(1, 1, arguments.length, funcName);
+    checkArgumentType(arguments, 'function', 0, funcName);
+    const loop = () => this.next().then((group) => {
+      if (!group) return;
+      callback(group);
+      return loop();
+    });
+    return loop();
+  }
+
+  /**
+   * Get the statistics of the capture
+   * @return {MultiDeviceCaptureStatistics|undefined}
+   */
+  get statistics() {
+    return this.cxxCapture ? this.cxxCapture.getStatistics() : undefined;
+  }
+
+  /**
+   * Stop the devices and release the resources, the native threads stop once the pending
+   * [next()]{@link MultiDeviceCapture#next} calls return
+   * @return {undefined}
+   */
+  destroy() {
+    if (this.cxxCapture) {
+      this.cxxCapture.destroy();
+      this.cxxCapture = undefined;
+    }
+    this.ownConfigs.forEach((config) => config.destroy());
+    this.ownConfigs = [];
+    if (this.ownCtx && this.ctx) this.ctx.destroy();
+    this.ctx = undefined;
+  }
 }
 
 /**
@@ -6274,6 +7489,13 @@ module.exports = {
   MotionStreamProfile: MotionStreamProfile,
   Frame: Frame,
   FrameSet: FrameSet,
+  FrameStream: FrameStream,
+  roiStatisticsLayout: roiStatisticsLayout,
+  FramePool: FramePool,
+  PlaybackReader: PlaybackReader,
+  MultiDeviceCapture: MultiDeviceCapture,
+  SharedFramePool: SharedFramePool,
+  SharedFrameSlots: SharedFrameSlots,
   VideoFrame: VideoFrame,
   DepthFrame: DepthFrame,
   DisparityFrame: DisparityFrame,
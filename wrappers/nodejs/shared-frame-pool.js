@@ -0,0 +1,156 @@
+// Copyright (c) 2018 Intel Corporation. All rights reserved.
+// Use of this source code is governed by an Apache 2.0 license
+// that can be found in the LICENSE file.
+
+'use strict';
+
+// This file must not load the native addon, it is required from worker_threads where the addon
+// can't be loaded.
+
+// Fields stored in the header of each slot
+const slotHeaderLayout = {
+  WIDTH: 0,
+  HEIGHT: 1,
+  STRIDE_IN_BYTES: 2,
+  BITS_PER_PIXEL: 3,
+  FORMAT: 4,
+  STREAM_TYPE: 5,
+  TIMESTAMP: 6,
+  FRAME_NUMBER: 7,
+  DATA_BYTE_LENGTH: 8,
+  FIELD_COUNT: 9,
+};
+
+// Slot states, stored in an Int32Array so they can be used with Atomics
+const slotState = {
+  FREE: 0,
+  WRITING: 1,
+  READY: 2,
+};
+
+/**
+ * Header of a frame stored in a {@link SharedFrameSlots} slot
+ * @typedef {Object} SharedFrameHeader
+ * @property {Integer} slot - The slot index
+ * @property {Integer} width - The width in pixels, 0 for non-video frames
+ * @property {Integer} height - The height in pixels, 0 for non-video frames
+ * @property {Integer} strideInBytes - The stride in bytes, 0 for non-video frames
+ * @property {Integer} bitsPerPixel - The number of bits per pixel, 0 for non-video frames
+ * @property {Integer} format - see {@link format} for avaiable values
+ * @property {Integer} streamType - see {@link stream} for avaiable values
+ * @property {Number} timestamp - The timestamp of the frame
+ * @property {Integer} frameNumber - The frame number
+ * @property {Integer} dataByteLength - The length of the frame data in bytes
+ */
+
+/**
+ * A view on the slots of a {@link SharedFramePool}, usable from any thread.
+ * In a worker, create it from the handles posted by the main thread:
+ * <pre><code>
+ *  const {SharedFrameSlots} = require('node-librealsense/shared-frame-pool.js');
+ *  const slots = new SharedFrameSlots(workerData.handles);
+ *  parentPort.on('message', (slot) => {
+ *    const data = slots.getData(slot);
+ *    // ... analyze data ...
+ *    slots.release(slot);
+ *  });
+ * </code></pre>
+ */
+class SharedFrameSlots {
+  /**
+   * @param {Object} handles the value of [SharedFramePool.handles]{@link SharedFrameSlots#handles}
+   */
+  constructor(handles) {
+    this.slotCount = handles.slotCount;
+    this.slotByteLength = handles.slotByteLength;
+    this.dataBuffer = handles.dataBuffer;
+    this.headerBuffer = handles.headerBuffer;
+    this.stateBuffer = handles.stateBuffer;
+    this.headers = new Float64Array(this.headerBuffer);
+    this.states = new Int32Array(this.stateBuffer);
+  }
+
+  /**
+   * The shared buffers of the slots, to be passed to a worker (through <code>workerData</code>
+   * or <code>postMessage</code>) without copying.
+   * @return {Object}
+   */
+  get handles() {
+    return {
+      slotCount: this.slotCount,
+      slotByteLength: this.slotByteLength,
+      dataBuffer: this.dataBuffer,
+      headerBuffer: this.headerBuffer,
+      stateBuffer: this.stateBuffer,
+    };
+  }
+
+  /**
+   * Check if a slot holds a frame
+   * @param {Integer} slot the slot index
+   * @return {Boolean}
+   */
+  isReady(slot) {
+    return Atomics.load(this.states, slot) === slotState.READY;
+  }
+
+  /**
+   * Get the header of the frame held by a slot
+   * @param {Integer} slot the slot index
+   * @param {Object} [target] the object to be filled, to avoid an allocation per frame
+   * @return {SharedFrameHeader}
+   */
+  getHeader(slot, target = {}) {
+    const h = this.headers.subarray(slot * slotHeaderLayout.FIELD_COUNT);
+    target.slot = slot;
+    target.width = h[slotHeaderLayout.WIDTH];
+    target.height = h[slotHeaderLayout.HEIGHT];
+    target.strideInBytes = h[slotHeaderLayout.STRIDE_IN_BYTES];
+    target.bitsPerPixel = h[slotHeaderLayout.BITS_PER_PIXEL];
+    target.format = h[slotHeaderLayout.FORMAT];
+    target.streamType = h[slotHeaderLayout.STREAM_TYPE];
+    target.timestamp = h[slotHeaderLayout.TIMESTAMP];
+    target.frameNumber = h[slotHeaderLayout.FRAME_NUMBER];
+    target.dataByteLength = h[slotHeaderLayout.DATA_BYTE_LENGTH];
+    return target;
+  }
+
+  /**
+   * Get the data of the frame held by a slot, the returned array is a view on the shared memory
+   * and is only valid until the slot is released
+   * @param {Integer} slot the slot index
+   * @return {Uint8Array}
+   */
+  getData(slot) {
+    const length = this.headers[slot * slotHeaderLayout.FIELD_COUNT +
+        slotHeaderLayout.DATA_BYTE_LENGTH];
+    return new Uint8Array(this.dataBuffer, slot * this.slotByteLength, length);
+  }
+
+  /**
+   * Give a slot back to the pool once its frame has been consumed
+   * @param {Integer} slot the slot index
+   * @return {undefined}
+   */
+  release(slot) {
+    Atomics.store(this.states, slot, slotState.FREE);
+  }
+
+  /**
+   * Count of slots currently holding a frame
+   * @return {Integer}
+   */
+  get busySlots() {
+    let count = 0;
+    for (let i = 0; i < this.slotCount; i++) {
+      if (Atomics.load(this.states, i) !== slotState.FREE) count++;
+    }
+    return count;
+  }
+}
+
+module.exports = {
+  SharedFrameSlots: SharedFrameSlots,
+  slotHeaderLayout: slotHeaderLayout,
+  slotState: slotState,
+};
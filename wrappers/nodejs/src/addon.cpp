@@ -6,13 +6,21 @@
 #include <librealsense2/h/rs_internal.h>
 #include <librealsense2/h/rs_pipeline.h>
 #include <librealsense2/hpp/rs_types.hpp>
+#include <librealsense2/rsutil.h>
 #include <nan.h>
 
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
 #include <iostream>
+#include <limits>
 #include <list>
 #include <memory>
+#include <mutex>
 #include <sstream>
 #include <string>
+#include <thread>
 #include <utility>
 #include <vector>
 
@@ -654,6 +662,8 @@ class RSFrame : public Nan::ObjectWrap {
     Nan::SetPrototypeMethod(tpl, "getStreamProfile", GetStreamProfile);
     Nan::SetPrototypeMethod(tpl, "getData", GetData);
     Nan::SetPrototypeMethod(tpl, "writeData", WriteData);
+    Nan::SetPrototypeMethod(tpl, "writeDataToSharedBuffer",
+        WriteDataToSharedBuffer);
     Nan::SetPrototypeMethod(tpl, "getWidth", GetWidth);
     Nan::SetPrototypeMethod(tpl, "getHeight", GetHeight);
     Nan::SetPrototypeMethod(tpl, "getStrideInBytes", GetStrideInBytes);
@@ -661,6 +671,7 @@ class RSFrame : public Nan::ObjectWrap {
     Nan::SetPrototypeMethod(tpl, "getTimestamp", GetTimestamp);
     Nan::SetPrototypeMethod(tpl, "getTimestampDomain", GetTimestampDomain);
     Nan::SetPrototypeMethod(tpl, "getFrameNumber", GetFrameNumber);
+    Nan::SetPrototypeMethod(tpl, "getSnapshot", GetSnapshot);
     Nan::SetPrototypeMethod(tpl, "getFrameMetadata", GetFrameMetadata);
     Nan::SetPrototypeMethod(tpl, "supportsFrameMetadata",
         SupportsFrameMetadata);
@@ -684,6 +695,9 @@ class RSFrame : public Nan::ObjectWrap {
     Nan::SetPrototypeMethod(tpl, "exportToPly", ExportToPly);
     Nan::SetPrototypeMethod(tpl, "isValid", IsValid);
     Nan::SetPrototypeMethod(tpl, "getDistance", GetDistance);
+    Nan::SetPrototypeMethod(tpl, "getRoiStatisticsAsync",
+        GetRoiStatisticsAsync);
+    Nan::SetPrototypeMethod(tpl, "deprojectAsync", DeprojectAsync);
     Nan::SetPrototypeMethod(tpl, "getBaseLine", GetBaseLine);
     Nan::SetPrototypeMethod(tpl, "keep", Keep);
     Nan::SetPrototypeMethod(tpl, "getMotionData", GetMotionData);
@@ -709,6 +723,31 @@ class RSFrame : public Nan::ObjectWrap {
     return scope.Escape(instance);
   }
 
+  // Slots of the header array filled by getSnapshot(), must be kept in sync
+  // with frameSnapshotLayout in index.js
+  enum SnapshotField {
+    kSnapshotWidth = 0,
+    kSnapshotHeight,
+    kSnapshotStrideInBytes,
+    kSnapshotBitsPerPixel,
+    kSnapshotTimestamp,
+    kSnapshotTimestampDomain,
+    kSnapshotFrameNumber,
+    kSnapshotDataByteLength,
+    kSnapshotFieldCount
+  };
+
+  // Values of each rectangle filled by getRoiStatisticsAsync(), must be kept
+  // in sync with roiStatisticsLayout in index.js
+  enum RoiField {
+    kRoiCount = 0,
+    kRoiMin,
+    kRoiMax,
+    kRoiMean,
+    kRoiMedian,
+    kRoiFieldCount
+  };
+
   void Replace(rs2_frame* value) {
     DestroyMe();
     frame_ = value;
@@ -716,11 +755,183 @@ class RSFrame : public Nan::ObjectWrap {
     Nan::MakeCallback(handle(), "_internalResetBuffer", 0, nullptr);
   }
 
+  // count of wrappers that have not been garbage collected yet
+  static uint32_t live_instances_;
+
  private:
-  RSFrame() : frame_(nullptr), error_(nullptr) {}
+  // Runs a kernel over the pixels of a depth frame in the libuv thread pool
+  // and calls the js callback as (error, count of valid pixels). The worker
+  // holds its own reference of the frame, so the js frame may be released
+  // meanwhile.
+  class DepthKernelWorker : public Nan::AsyncWorker {
+   public:
+    enum Kernel {
+      kRoiStatistics = 0,
+      kDeproject,
+    };
+
+    DepthKernelWorker(Kernel kernel, rs2_frame* frame,
+        Nan::Callback* callback)
+        : Nan::AsyncWorker(callback), kernel_(kernel), frame_(frame),
+          data_(nullptr), width_(0), height_(0), stride_(0), units_(0),
+          output_(nullptr), valid_(0) {}
+
+    ~DepthKernelWorker() {
+      rs2_release_frame(frame_);
+    }
+
+    void Execute() override {
+      if (kernel_ == kRoiStatistics) {
+        ComputeRoiStatistics();
+      } else {
+        Deproject();
+      }
+    }
+
+    void HandleOKCallback() override {
+      Nan::HandleScope scope;
+      v8::Local<v8::Value> argv[2] = {
+        Nan::Null(), Nan::New(static_cast<double>(valid_))
+      };
+      callback->Call(2, argv);
+    }
+
+   private:
+    const uint16_t* Row(int y) const {
+      return reinterpret_cast<const uint16_t*>(data_ + y * stride_);
+    }
+
+    void ComputeRoiStatistics() {
+      auto out = static_cast<double*>(output_);
+      std::vector<uint32_t> histogram(1 << 16, 0);
+      for (size_t i = 0; i + 3 < rects_.size(); i += 4) {
+        int x0 = std::max(0, rects_[i]);
+        int y0 = std::max(0, rects_[i + 1]);
+        int x1 = std::min(width_, rects_[i] + rects_[i + 2]);
+        int y1 = std::min(height_, rects_[i + 1] + rects_[i + 3]);
+        uint64_t count = 0;
+        uint64_t sum = 0;
+        uint16_t lo = 0xffff;
+        uint16_t hi = 0;
+        for (int y = y0; y < y1; y++) {
+          const uint16_t* row = Row(y);
+          for (int x = x0; x < x1; x++) {
+            uint16_t v = row[x];
+            if (!v) continue;
+            histogram[v]++;
+            count++;
+            sum += v;
+            lo = std::min(lo, v);
+            hi = std::max(hi, v);
+          }
+        }
+
+        double* roi = out + (i / 4) * kRoiFieldCount;
+        roi[kRoiCount] = static_cast<double>(count);
+        if (!count) {
+          roi[kRoiMin] = roi[kRoiMax] = roi[kRoiMean] = roi[kRoiMedian] =
+              std::numeric_limits<double>::quiet_NaN();
+          continue;
+        }
+        // the median is read from the histogram, which is also cleared on the
+        // way for the next rectangle
+        uint64_t half = (count + 1) / 2;
+        uint64_t seen = 0;
+        uint32_t median = lo;
+        for (uint32_t v = lo; v <= hi; v++) {
+          if (seen < half) {
+            seen += histogram[v];
+            median = v;
+          }
+          histogram[v] = 0;
+        }
+        roi[kRoiMin] = lo * units_;
+        roi[kRoiMax] = hi * units_;
+        roi[kRoiMean] = sum * units_ / count;
+        roi[kRoiMedian] = median * units_;
+        valid_ += count;
+      }
+    }
+
+    void Deproject() {
+      auto out = static_cast<float*>(output_);
+      for (int y = 0; y < height_; y++) {
+        const uint16_t* row = Row(y);
+        float* point = out + static_cast<size_t>(y) * width_ * 3;
+        for (int x = 0; x < width_; x++, point += 3) {
+          uint16_t v = row[x];
+          if (!v) {
+            point[0] = point[1] = point[2] = 0;
+            continue;
+          }
+          const float pixel[2] = { static_cast<float>(x),
+              static_cast<float>(y) };
+          rs2_deproject_pixel_to_point(point, &intrinsics_, pixel,
+              v * units_);
+          valid_++;
+        }
+      }
+    }
+
+    Kernel kernel_;
+    rs2_frame* frame_;
+    const uint8_t* data_;
+    int width_;
+    int height_;
+    int stride_;
+    float units_;
+    rs2_intrinsics intrinsics_;
+    std::vector<int32_t> rects_;
+    void* output_;
+    uint64_t valid_;
+    friend class RSFrame;
+  };
+
+  // Collects on the main thread what the kernel needs from the frame, returns
+  // nullptr if the frame isn't a valid depth frame
+  DepthKernelWorker* CreateDepthKernelWorker(DepthKernelWorker::Kernel kernel,
+      v8::Local<v8::Value> callback) {
+    if (!frame_) return nullptr;
+    if (!GetNativeResult<int>(rs2_is_frame_extendable_to, &error_, frame_,
+        RS2_EXTENSION_DEPTH_FRAME, &error_)) {
+      return nullptr;
+    }
+    std::shared_ptr<rs2_sensor> sensor(GetNativeResult<rs2_sensor*>(
+        rs2_get_frame_sensor, &error_, frame_, &error_), rs2_delete_sensor);
+    if (!sensor) return nullptr;
+    float units = GetNativeResult<float>(rs2_get_depth_scale, &error_,
+        sensor.get(), &error_);
+    auto profile = GetNativeResult<const rs2_stream_profile*>(
+        rs2_get_frame_stream_profile, &error_, frame_, &error_);
+    if (error_ || !profile) return nullptr;
+    rs2_intrinsics intrinsics;
+    CallNativeFunc(rs2_get_video_stream_intrinsics, &error_, profile,
+        &intrinsics, &error_);
+    auto data = GetNativeResult<const void*>(rs2_get_frame_data, &error_,
+        frame_, &error_);
+    if (error_ || !data) return nullptr;
+    CallNativeFunc(rs2_frame_add_ref, &error_, frame_, &error_);
+    if (error_) return nullptr;
+
+    auto worker = new DepthKernelWorker(kernel, frame_,
+        new Nan::Callback(callback.As<v8::Function>()));
+    worker->data_ = static_cast<const uint8_t*>(data);
+    worker->width_ = intrinsics.width;
+    worker->height_ = intrinsics.height;
+    worker->stride_ = GetNativeResult<int>(rs2_get_frame_stride_in_bytes,
+        &error_, frame_, &error_);
+    worker->units_ = units;
+    worker->intrinsics_ = intrinsics;
+    return worker;
+  }
+
+  RSFrame() : frame_(nullptr), error_(nullptr) {
+    live_instances_++;
+  }
 
   ~RSFrame() {
     DestroyMe();
+    live_instances_--;
   }
 
   void DestroyMe() {
@@ -862,6 +1073,30 @@ class RSFrame : public Nan::ObjectWrap {
     }
   }
 
+  // Copy the frame data into a SharedArrayBuffer at byte offset info[1],
+  // writing at most info[2] bytes. Returns the count of bytes written.
+  static NAN_METHOD(WriteDataToSharedBuffer) {
+    info.GetReturnValue().Set(Nan::New(0));
+    auto me = Nan::ObjectWrap::Unwrap<RSFrame>(info.Holder());
+    if (!me || !me->frame_ || !info[0]->IsSharedArrayBuffer()) return;
+
+    auto shared_buffer = v8::Local<v8::SharedArrayBuffer>::Cast(info[0]);
+    const size_t offset = info[1]->IntegerValue();
+    const size_t max_length = info[2]->IntegerValue();
+    const auto buffer = GetNativeResult<const void*>(rs2_get_frame_data,
+        &me->error_, me->frame_, &me->error_);
+    const auto length = GetNativeResult<int>(rs2_get_frame_data_size,
+        &me->error_, me->frame_, &me->error_);
+    if (!buffer || length <= 0) return;
+
+    auto contents = shared_buffer->GetContents();
+    const size_t size = static_cast<size_t>(length);
+    if (size > max_length || offset + size > contents.ByteLength()) return;
+
+    memcpy(static_cast<uint8_t*>(contents.Data()) + offset, buffer, size);
+    info.GetReturnValue().Set(Nan::New(length));
+  }
+
   static NAN_METHOD(GetWidth) {
     info.GetReturnValue().Set(Nan::Undefined());
     auto me = Nan::ObjectWrap::Unwrap<RSFrame>(info.Holder());
@@ -932,6 +1167,75 @@ class RSFrame : public Nan::ObjectWrap {
     info.GetReturnValue().Set(Nan::New(value));
   }
 
+  // Fill info[0] (Float64Array, see SnapshotField) with the frame header and,
+  // if present, info[1] (Float64Array indexed by rs2_frame_metadata_value)
+  // with every metadata value, NaN for the unsupported ones. This replaces
+  // up to 40 separate calls into native with a single one.
+  static NAN_METHOD(GetSnapshot) {
+    info.GetReturnValue().Set(Nan::False());
+    auto me = Nan::ObjectWrap::Unwrap<RSFrame>(info.Holder());
+    if (!me || !me->frame_) return;
+
+    Nan::TypedArrayContents<double> header(info[0]);
+    double* out = *header;
+    if (!out || header.length() < kSnapshotFieldCount) return;
+
+    // Every call resets error_, so it's checked after each of them
+    out[kSnapshotTimestamp] = GetNativeResult<double>(rs2_get_frame_timestamp,
+        &me->error_, me->frame_, &me->error_);
+    if (me->error_) return;
+    out[kSnapshotTimestampDomain] = GetNativeResult<rs2_timestamp_domain>(
+        rs2_get_frame_timestamp_domain, &me->error_, me->frame_, &me->error_);
+    if (me->error_) return;
+    out[kSnapshotFrameNumber] = GetNativeResult<uint64_t>(rs2_get_frame_number,
+        &me->error_, me->frame_, &me->error_);
+    if (me->error_) return;
+    out[kSnapshotDataByteLength] = GetNativeResult<int>(rs2_get_frame_data_size,
+        &me->error_, me->frame_, &me->error_);
+    if (me->error_) return;
+
+    out[kSnapshotWidth] = 0;
+    out[kSnapshotHeight] = 0;
+    out[kSnapshotStrideInBytes] = 0;
+    out[kSnapshotBitsPerPixel] = 0;
+    bool is_video = GetNativeResult<int>(rs2_is_frame_extendable_to,
+        &me->error_, me->frame_, RS2_EXTENSION_VIDEO_FRAME, &me->error_);
+    if (me->error_) return;
+    if (is_video) {
+      out[kSnapshotWidth] = GetNativeResult<int>(rs2_get_frame_width,
+          &me->error_, me->frame_, &me->error_);
+      if (me->error_) return;
+      out[kSnapshotHeight] = GetNativeResult<int>(rs2_get_frame_height,
+          &me->error_, me->frame_, &me->error_);
+      if (me->error_) return;
+      out[kSnapshotStrideInBytes] = GetNativeResult<int>(
+          rs2_get_frame_stride_in_bytes, &me->error_, me->frame_, &me->error_);
+      if (me->error_) return;
+      out[kSnapshotBitsPerPixel] = GetNativeResult<int>(
+          rs2_get_frame_bits_per_pixel, &me->error_, me->frame_, &me->error_);
+      if (me->error_) return;
+    }
+
+    if (info.Length() > 1 && info[1]->IsFloat64Array()) {
+      Nan::TypedArrayContents<double> metadata(info[1]);
+      double* values = *metadata;
+      const size_t count = std::min<size_t>(metadata.length(),
+          RS2_FRAME_METADATA_COUNT);
+      for (size_t i = 0; i < count; i++) {
+        auto type = static_cast<rs2_frame_metadata_value>(i);
+        values[i] = std::numeric_limits<double>::quiet_NaN();
+        bool supported = GetNativeResult<int>(rs2_supports_frame_metadata,
+            &me->error_, me->frame_, type, &me->error_);
+        if (me->error_ || !supported) continue;
+        auto value = GetNativeResult<rs2_metadata_type>(rs2_get_frame_metadata,
+            &me->error_, me->frame_, type, &me->error_);
+        // a value that can't be read stays NaN, like an unsupported one
+        if (!me->error_) values[i] = value;
+      }
+    }
+    info.GetReturnValue().Set(Nan::True());
+  }
+
   static NAN_METHOD(IsVideoFrame) {
     info.GetReturnValue().Set(Nan::Undefined());
     auto me = Nan::ObjectWrap::Unwrap<RSFrame>(info.Holder());
@@ -1215,6 +1519,55 @@ class RSFrame : public Nan::ObjectWrap {
     info.GetReturnValue().Set(Nan::New(val));
   }
 
+  // getRoiStatisticsAsync(rects, result, callback): rects is an Int32Array of
+  // (x, y, width, height) tuples, result a Float64Array of kRoiFieldCount
+  // values per rectangle, in meters.
+  static NAN_METHOD(GetRoiStatisticsAsync) {
+    info.GetReturnValue().Set(Nan::False());
+    auto me = Nan::ObjectWrap::Unwrap<RSFrame>(info.Holder());
+    if (!me) return;
+
+    Nan::TypedArrayContents<int32_t> rects(info[0]);
+    Nan::TypedArrayContents<double> result(info[1]);
+    const size_t count = rects.length() / 4;
+    if (!*rects || !*result || result.length() < count * kRoiFieldCount)
+      return;
+
+    auto worker = me->CreateDepthKernelWorker(
+        DepthKernelWorker::kRoiStatistics, info[2]);
+    if (!worker) return;
+    worker->rects_.assign(*rects, *rects + count * 4);
+    worker->output_ = *result;
+    // keep the result array alive until the worker is done with it
+    worker->SaveToPersistent("result", info[1]);
+    Nan::AsyncQueueWorker(worker);
+    info.GetReturnValue().Set(Nan::True());
+  }
+
+  // deprojectAsync(points, callback): fills the Float32Array points with the
+  // (x, y, z) coordinates in meters of every pixel, 0 where there's no depth.
+  static NAN_METHOD(DeprojectAsync) {
+    info.GetReturnValue().Set(Nan::False());
+    auto me = Nan::ObjectWrap::Unwrap<RSFrame>(info.Holder());
+    if (!me) return;
+
+    Nan::TypedArrayContents<float> points(info[0]);
+    if (!*points) return;
+
+    auto worker = me->CreateDepthKernelWorker(DepthKernelWorker::kDeproject,
+        info[1]);
+    if (!worker) return;
+    if (points.length() <
+        static_cast<size_t>(worker->width_) * worker->height_ * 3) {
+      delete worker;
+      return;
+    }
+    worker->output_ = *points;
+    worker->SaveToPersistent("points", info[0]);
+    Nan::AsyncQueueWorker(worker);
+    info.GetReturnValue().Set(Nan::True());
+  }
+
   static NAN_METHOD(GetBaseLine) {
     auto me = Nan::ObjectWrap::Unwrap<RSFrame>(info.Holder());
     info.GetReturnValue().Set(Nan::Undefined());
@@ -1272,6 +1625,7 @@ class RSFrame : public Nan::ObjectWrap {
 };
 
 Nan::Persistent<v8::Function> RSFrame::constructor_;
+uint32_t RSFrame::live_instances_ = 0;
 
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -1302,6 +1656,7 @@ class RSFrameQueue : public Nan::ObjectWrap {
     Nan::SetPrototypeMethod(tpl, "create", Create);
     Nan::SetPrototypeMethod(tpl, "destroy", Destroy);
     Nan::SetPrototypeMethod(tpl, "waitForFrame", WaitForFrame);
+    Nan::SetPrototypeMethod(tpl, "waitForFrameAsync", WaitForFrameAsync);
     Nan::SetPrototypeMethod(tpl, "pollForFrame", PollForFrame);
     Nan::SetPrototypeMethod(tpl, "enqueueFrame", EnqueueFrame);
 
@@ -1323,7 +1678,61 @@ class RSFrameQueue : public Nan::ObjectWrap {
   }
 
  private:
-  RSFrameQueue() : frame_queue_(nullptr), error_(nullptr) {}
+  // Blocks on the queue in the libuv thread pool and passes the frame to the
+  // js callback as (error, RSFrame) on the main thread.
+  class WaitForFrameWorker : public Nan::AsyncWorker {
+   public:
+    WaitForFrameWorker(RSFrameQueue* queue, uint32_t timeout, RSFrame* target,
+        Nan::Callback* callback)
+        : Nan::AsyncWorker(callback), queue_(queue), timeout_(timeout),
+          target_(target), frame_(nullptr) {
+      queue_->pending_waits_++;
+    }
+
+    ~WaitForFrameWorker() {
+      if (frame_) rs2_release_frame(frame_);
+    }
+
+    void Execute() override {
+      rs2_error* error = nullptr;
+      rs2_try_wait_for_frame(queue_->frame_queue_, timeout_, &frame_, &error);
+      if (error) {
+        SetErrorMessage(rs2_get_error_message(error));
+        rs2_free_error(error);
+        frame_ = nullptr;
+      }
+    }
+
+    // A timeout isn't an error, the callback gets no frame instead
+    void HandleOKCallback() override {
+      Nan::HandleScope scope;
+      v8::Local<v8::Value> argv[2] = { Nan::Null(), Nan::Undefined() };
+      if (frame_ && target_) {
+        // recycle the wrapper given by the caller instead of creating one
+        target_->Replace(frame_);
+        argv[1] = GetFromPersistent("target");
+      } else if (frame_) {
+        argv[1] = RSFrame::NewInstance(frame_);
+      }
+      frame_ = nullptr;
+      queue_->WaitFinished();
+      callback->Call(2, argv);
+    }
+
+    void HandleErrorCallback() override {
+      queue_->WaitFinished();
+      Nan::AsyncWorker::HandleErrorCallback();
+    }
+
+   private:
+    RSFrameQueue* queue_;
+    uint32_t timeout_;
+    RSFrame* target_;
+    rs2_frame* frame_;
+  };
+
+  RSFrameQueue() : frame_queue_(nullptr), error_(nullptr), pending_waits_(0),
+      destroy_pending_(false) {}
 
   ~RSFrameQueue() {
     DestroyMe();
@@ -1332,8 +1741,20 @@ class RSFrameQueue : public Nan::ObjectWrap {
   void DestroyMe() {
     if (error_) rs2_free_error(error_);
     error_ = nullptr;
+    // The queue is still used by a worker thread, delete it once the wait
+    // returns.
+    if (pending_waits_) {
+      destroy_pending_ = true;
+      return;
+    }
     if (frame_queue_) rs2_delete_frame_queue(frame_queue_);
     frame_queue_ = nullptr;
+    destroy_pending_ = false;
+  }
+
+  void WaitFinished() {
+    pending_waits_--;
+    if (!pending_waits_ && destroy_pending_) DestroyMe();
   }
 
   static void New(const Nan::FunctionCallbackInfo<v8::Value>& info) {
@@ -1357,6 +1778,23 @@ class RSFrameQueue : public Nan::ObjectWrap {
     info.GetReturnValue().Set(RSFrame::NewInstance(frame));
   }
 
+  static NAN_METHOD(WaitForFrameAsync) {
+    info.GetReturnValue().Set(Nan::Undefined());
+    int32_t timeout = info[0]->IntegerValue();  // in ms
+    auto me = Nan::ObjectWrap::Unwrap<RSFrameQueue>(info.Holder());
+    if (!me || !me->frame_queue_ || me->destroy_pending_) return;
+
+    RSFrame* target = nullptr;
+    if (info[2]->IsObject())
+      target = Nan::ObjectWrap::Unwrap<RSFrame>(info[2]->ToObject());
+    auto worker = new WaitForFrameWorker(me, timeout, target,
+        new Nan::Callback(info[1].As<v8::Function>()));
+    // keep the queue and the target alive until the worker is done with them
+    worker->SaveToPersistent("queue", info.Holder());
+    if (target) worker->SaveToPersistent("target", info[2]);
+    Nan::AsyncQueueWorker(worker);
+  }
+
   static NAN_METHOD(Create) {
     info.GetReturnValue().Set(Nan::Undefined());
     int32_t capacity = info[0]->IntegerValue();
@@ -1403,7 +1841,10 @@ class RSFrameQueue : public Nan::ObjectWrap {
   static Nan::Persistent<v8::Function> constructor_;
   rs2_frame_queue* frame_queue_;
   rs2_error* error_;
+  uint32_t pending_waits_;
+  bool destroy_pending_;
   friend class RSDevice;
+  friend class RSSensor;
 };
 
 Nan::Persistent<v8::Function> RSFrameQueue::constructor_;
@@ -1599,14 +2040,19 @@ class RSFrameSet : public Nan::ObjectWrap {
     SetFrame(frame);
   }
 
+  // count of wrappers that have not been garbage collected yet
+  static uint32_t live_instances_;
+
  private:
   RSFrameSet() {
     error_ = nullptr;
     frames_ = nullptr;
+    live_instances_++;
   }
 
   ~RSFrameSet() {
     DestroyMe();
+    live_instances_--;
   }
 
   void SetFrame(rs2_frame* frame) {
@@ -1786,6 +2232,7 @@ class RSFrameSet : public Nan::ObjectWrap {
 };
 
 Nan::Persistent<v8::Function> RSFrameSet::constructor_;
+uint32_t RSFrameSet::live_instances_ = 0;
 
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
@@ -2009,6 +2456,7 @@ class RSSensor : public Nan::ObjectWrap, Options {
     Nan::SetPrototypeMethod(tpl, "getCameraInfo", GetCameraInfo);
     Nan::SetPrototypeMethod(tpl, "startWithSyncer", StartWithSyncer);
     Nan::SetPrototypeMethod(tpl, "startWithCallback", StartWithCallback);
+    Nan::SetPrototypeMethod(tpl, "startWithFrameQueue", StartWithFrameQueue);
     Nan::SetPrototypeMethod(tpl, "supportsOption", SupportsOption);
     Nan::SetPrototypeMethod(tpl, "getOption", GetOption);
     Nan::SetPrototypeMethod(tpl, "setOption", SetOption);
@@ -2183,6 +2631,16 @@ class RSSensor : public Nan::ObjectWrap, Options {
         new FrameCallbackForProcessingBlock(syncer->syncer_), &me->error_);
   }
 
+  static NAN_METHOD(StartWithFrameQueue) {
+    info.GetReturnValue().Set(Nan::Undefined());
+    auto queue = Nan::ObjectWrap::Unwrap<RSFrameQueue>(info[0]->ToObject());
+    auto me = Nan::ObjectWrap::Unwrap<RSSensor>(info.Holder());
+    if (!me || !queue || !queue->frame_queue_) return;
+
+    CallNativeFunc(rs2_start_cpp, &me->error_, me->sensor_,
+        new FrameCallbackForFrameQueue(queue->frame_queue_), &me->error_);
+  }
+
   static NAN_METHOD(StartWithCallback) {
     auto frame = Nan::ObjectWrap::Unwrap<RSFrame>(info[1]->ToObject());
     auto depth_frame = Nan::ObjectWrap::Unwrap<RSFrame>(info[2]->ToObject());
@@ -2440,6 +2898,7 @@ class RSDevice : public Nan::ObjectWrap {
     Nan::SetPrototypeMethod(tpl, "getPosition", GetPosition);
     Nan::SetPrototypeMethod(tpl, "getDuration", GetDuration);
     Nan::SetPrototypeMethod(tpl, "seek", Seek);
+    Nan::SetPrototypeMethod(tpl, "seekAsync", SeekAsync);
     Nan::SetPrototypeMethod(tpl, "isRealTime", IsRealTime);
     Nan::SetPrototypeMethod(tpl, "setIsRealTime", SetIsRealTime);
     Nan::SetPrototypeMethod(tpl, "setPlaybackSpeed", SetPlaybackSpeed);
@@ -2480,8 +2939,44 @@ class RSDevice : public Nan::ObjectWrap {
   }
 
  private:
+  // Seeks the playback in the libuv thread pool and calls the js callback as
+  // (error) on the main thread.
+  class SeekWorker : public Nan::AsyncWorker {
+   public:
+    SeekWorker(RSDevice* dev, uint64_t time, Nan::Callback* callback)
+        : Nan::AsyncWorker(callback), dev_(dev), time_(time) {
+      dev_->pending_seeks_++;
+    }
+
+    void Execute() override {
+      rs2_error* error = nullptr;
+      rs2_playback_seek(dev_->dev_, time_*1000000, &error);
+      if (error) {
+        SetErrorMessage(rs2_get_error_message(error));
+        rs2_free_error(error);
+      }
+    }
+
+    void HandleOKCallback() override {
+      Nan::HandleScope scope;
+      dev_->SeekFinished();
+      v8::Local<v8::Value> argv[1] = { Nan::Null() };
+      callback->Call(1, argv);
+    }
+
+    void HandleErrorCallback() override {
+      dev_->SeekFinished();
+      Nan::AsyncWorker::HandleErrorCallback();
+    }
+
+   private:
+    RSDevice* dev_;
+    uint64_t time_;
+  };
+
   explicit RSDevice(DeviceType type = kNormalDevice) : dev_(nullptr),
-      error_(nullptr), type_(type) {}
+      error_(nullptr), type_(type), pending_seeks_(0),
+      destroy_pending_(false) {}
 
   ~RSDevice() {
     DestroyMe();
@@ -2490,8 +2985,20 @@ class RSDevice : public Nan::ObjectWrap {
   void DestroyMe() {
     if (error_) rs2_free_error(error_);
     error_ = nullptr;
+    // The device is still used by a worker thread, delete it once the seek
+    // returns.
+    if (pending_seeks_) {
+      destroy_pending_ = true;
+      return;
+    }
     if (dev_) rs2_delete_device(dev_);
     dev_ = nullptr;
+    destroy_pending_ = false;
+  }
+
+  void SeekFinished() {
+    pending_seeks_--;
+    if (!pending_seeks_ && destroy_pending_) DestroyMe();
   }
 
   static void New(const Nan::FunctionCallbackInfo<v8::Value>& info) {
@@ -2692,6 +3199,19 @@ class RSDevice : public Nan::ObjectWrap {
         &me->error_);
   }
 
+  static NAN_METHOD(SeekAsync) {
+    auto me = Nan::ObjectWrap::Unwrap<RSDevice>(info.Holder());
+    info.GetReturnValue().Set(Nan::Undefined());
+    if (!me || !me->dev_ || me->destroy_pending_) return;
+
+    uint64_t time = info[0]->IntegerValue();
+    auto worker = new SeekWorker(me, time,
+        new Nan::Callback(info[1].As<v8::Function>()));
+    // keep the device alive until the worker is done with it
+    worker->SaveToPersistent("device", info.Holder());
+    Nan::AsyncQueueWorker(worker);
+  }
+
   static NAN_METHOD(IsRealTime) {
     auto me = Nan::ObjectWrap::Unwrap<RSDevice>(info.Holder());
     info.GetReturnValue().Set(Nan::Undefined());
@@ -2845,6 +3365,8 @@ class RSDevice : public Nan::ObjectWrap {
   rs2_error* error_;
   DeviceType type_;
   std::string status_changed_callback_method_name_;
+  uint32_t pending_seeks_;
+  bool destroy_pending_;
   friend class RSContext;
   friend class DevicesChangedCallbackInfo;
   friend class FrameCallbackInfo;
@@ -3377,6 +3899,8 @@ class RSContext : public Nan::ObjectWrap {
   friend class DevicesChangedCallbackInfo;
   friend class RSPipeline;
   friend class RSDeviceHub;
+  friend class RSPlaybackPrefetcher;
+  friend class RSMultiDeviceCapture;
 };
 
 Nan::Persistent<v8::Function> RSContext::constructor_;
@@ -3815,6 +4339,8 @@ class RSConfig : public Nan::ObjectWrap  {
  private:
   static Nan::Persistent<v8::Function> constructor_;
   friend class RSPipeline;
+  friend class RSPlaybackPrefetcher;
+  friend class RSMultiDeviceCapture;
 
   rs2_config* config_;
   rs2_error* error_;
@@ -3833,6 +4359,7 @@ class RSPipeline : public Nan::ObjectWrap {
     Nan::SetPrototypeMethod(tpl, "startWithConfig", StartWithConfig);
     Nan::SetPrototypeMethod(tpl, "stop", Stop);
     Nan::SetPrototypeMethod(tpl, "waitForFrames", WaitForFrames);
+    Nan::SetPrototypeMethod(tpl, "waitForFramesAsync", WaitForFramesAsync);
     Nan::SetPrototypeMethod(tpl, "pollForFrames", PollForFrames);
     Nan::SetPrototypeMethod(tpl, "getActiveProfile", GetActiveProfile);
     Nan::SetPrototypeMethod(tpl, "create", Create);
@@ -3857,7 +4384,62 @@ class RSPipeline : public Nan::ObjectWrap {
  private:
   friend class RSConfig;
 
-  RSPipeline() : pipeline_(nullptr), error_(nullptr) {}
+  // Blocks on the pipeline in the libuv thread pool and passes the frameset
+  // to the js callback as (error, RSFrameSet) on the main thread.
+  class WaitForFramesWorker : public Nan::AsyncWorker {
+   public:
+    WaitForFramesWorker(RSPipeline* pipeline, uint32_t timeout,
+        RSFrameSet* target, Nan::Callback* callback)
+        : Nan::AsyncWorker(callback), pipeline_(pipeline), timeout_(timeout),
+          target_(target), frames_(nullptr) {
+      pipeline_->pending_waits_++;
+    }
+
+    ~WaitForFramesWorker() {
+      if (frames_) rs2_release_frame(frames_);
+    }
+
+    void Execute() override {
+      rs2_error* error = nullptr;
+      rs2_pipeline_try_wait_for_frames(pipeline_->pipeline_, &frames_, timeout_,
+          &error);
+      if (error) {
+        SetErrorMessage(rs2_get_error_message(error));
+        rs2_free_error(error);
+        frames_ = nullptr;
+      }
+    }
+
+    // A timeout isn't an error, the callback gets no frameset instead
+    void HandleOKCallback() override {
+      Nan::HandleScope scope;
+      v8::Local<v8::Value> argv[2] = { Nan::Null(), Nan::Undefined() };
+      if (frames_ && target_) {
+        // recycle the wrapper given by the caller instead of creating one
+        target_->Replace(frames_);
+        argv[1] = GetFromPersistent("target");
+      } else if (frames_) {
+        argv[1] = RSFrameSet::NewInstance(frames_);
+      }
+      frames_ = nullptr;
+      pipeline_->WaitFinished();
+      callback->Call(2, argv);
+    }
+
+    void HandleErrorCallback() override {
+      pipeline_->WaitFinished();
+      Nan::AsyncWorker::HandleErrorCallback();
+    }
+
+   private:
+    RSPipeline* pipeline_;
+    uint32_t timeout_;
+    RSFrameSet* target_;
+    rs2_frame* frames_;
+  };
+
+  RSPipeline() : pipeline_(nullptr), error_(nullptr), pending_waits_(0),
+      destroy_pending_(false) {}
 
   ~RSPipeline() {
     DestroyMe();
@@ -3866,8 +4448,20 @@ class RSPipeline : public Nan::ObjectWrap {
   void DestroyMe() {
     if (error_) rs2_free_error(error_);
     error_ = nullptr;
+    // The pipeline is still used by a worker thread, delete it once the wait
+    // returns.
+    if (pending_waits_) {
+      destroy_pending_ = true;
+      return;
+    }
     if (pipeline_) rs2_delete_pipeline(pipeline_);
     pipeline_ = nullptr;
+    destroy_pending_ = false;
+  }
+
+  void WaitFinished() {
+    pending_waits_--;
+    if (!pending_waits_ && destroy_pending_) DestroyMe();
   }
 
   static NAN_METHOD(Destroy) {
@@ -3944,6 +4538,24 @@ class RSPipeline : public Nan::ObjectWrap {
     info.GetReturnValue().Set(Nan::True());
   }
 
+  static NAN_METHOD(WaitForFramesAsync) {
+    info.GetReturnValue().Set(Nan::Undefined());
+    auto me = Nan::ObjectWrap::Unwrap<RSPipeline>(info.Holder());
+    if (!me || !me->pipeline_ || me->destroy_pending_) return;
+
+    auto timeout = info[0]->IntegerValue();
+    RSFrameSet* target = nullptr;
+    if (info[2]->IsObject())
+      target = Nan::ObjectWrap::Unwrap<RSFrameSet>(info[2]->ToObject());
+    auto worker = new WaitForFramesWorker(me, timeout, target,
+        new Nan::Callback(info[1].As<v8::Function>()));
+    // keep the pipeline and the target alive until the worker is done with
+    // them
+    worker->SaveToPersistent("pipeline", info.Holder());
+    if (target) worker->SaveToPersistent("target", info[2]);
+    Nan::AsyncQueueWorker(worker);
+  }
+
   static NAN_METHOD(PollForFrames) {
     info.GetReturnValue().Set(Nan::False());
     auto me = Nan::ObjectWrap::Unwrap<RSPipeline>(info.Holder());
@@ -3977,10 +4589,832 @@ class RSPipeline : public Nan::ObjectWrap {
 
   rs2_pipeline* pipeline_;
   rs2_error* error_;
+  uint32_t pending_waits_;
+  bool destroy_pending_;
 };
 
 Nan::Persistent<v8::Function> RSPipeline::constructor_;
 
+///////////////////////////////////////////////////////////////////////////////
+// Plays a recorded file through its own pipeline in non real time mode. A
+// native thread reads and decodes up to |capacity| framesets ahead of the js
+// consumer, so the file is drained as fast as it's consumed and no frame is
+// dropped.
+class RSPlaybackPrefetcher : public Nan::ObjectWrap {
+ public:
+  static void Init(v8::Local<v8::Object> exports) {
+    v8::Local<v8::FunctionTemplate> tpl = Nan::New<v8::FunctionTemplate>(New);
+    tpl->SetClassName(Nan::New("RSPlaybackPrefetcher").ToLocalChecked());
+    tpl->InstanceTemplate()->SetInternalFieldCount(1);
+
+    Nan::SetPrototypeMethod(tpl, "destroy", Destroy);
+    Nan::SetPrototypeMethod(tpl, "create", Create);
+    Nan::SetPrototypeMethod(tpl, "nextAsync", NextAsync);
+    Nan::SetPrototypeMethod(tpl, "seekAsync", SeekAsync);
+    Nan::SetPrototypeMethod(tpl, "getStatistics", GetStatistics);
+
+    constructor_.Reset(tpl->GetFunction());
+    exports->Set(Nan::New("RSPlaybackPrefetcher").ToLocalChecked(),
+        tpl->GetFunction());
+  }
+
+ private:
+  enum PopResult {
+    kPopFrames = 0,
+    kPopTimeout,
+    kPopEnd,
+    kPopError,
+  };
+
+  // Takes the next prefetched frameset in the libuv thread pool and passes it
+  // to the js callback as (error, RSFrameSet, ended). On timeout, the frameset
+  // is undefined and ended is false.
+  class NextWorker : public Nan::AsyncWorker {
+   public:
+    NextWorker(RSPlaybackPrefetcher* prefetcher, uint32_t timeout,
+        RSFrameSet* target, Nan::Callback* callback)
+        : Nan::AsyncWorker(callback), prefetcher_(prefetcher),
+          timeout_(timeout), target_(target), frames_(nullptr),
+          result_(kPopTimeout) {
+      prefetcher_->pending_ops_++;
+    }
+
+    ~NextWorker() {
+      if (frames_) rs2_release_frame(frames_);
+    }
+
+    void Execute() override {
+      std::string message;
+      result_ = prefetcher_->Pop(timeout_, &frames_, &message);
+      if (result_ == kPopError) SetErrorMessage(message.c_str());
+    }
+
+    void HandleOKCallback() override {
+      Nan::HandleScope scope;
+      v8::Local<v8::Value> argv[3] = {
+        Nan::Null(), Nan::Undefined(), Nan::New(result_ == kPopEnd)
+      };
+      if (frames_ && target_) {
+        target_->Replace(frames_);
+        argv[1] = GetFromPersistent("target");
+      } else if (frames_) {
+        argv[1] = RSFrameSet::NewInstance(frames_);
+      }
+      frames_ = nullptr;
+      prefetcher_->OperationFinished();
+      callback->Call(3, argv);
+    }
+
+    void HandleErrorCallback() override {
+      prefetcher_->OperationFinished();
+      Nan::AsyncWorker::HandleErrorCallback();
+    }
+
+   private:
+    RSPlaybackPrefetcher* prefetcher_;
+    uint32_t timeout_;
+    RSFrameSet* target_;
+    rs2_frame* frames_;
+    PopResult result_;
+  };
+
+  // Seeks in the libuv thread pool and calls the js callback as (error).
+  class SeekWorker : public Nan::AsyncWorker {
+   public:
+    SeekWorker(RSPlaybackPrefetcher* prefetcher, uint64_t time,
+        Nan::Callback* callback)
+        : Nan::AsyncWorker(callback), prefetcher_(prefetcher), time_(time) {
+      prefetcher_->pending_ops_++;
+    }
+
+    void Execute() override {
+      std::string message;
+      if (!prefetcher_->Seek(time_, &message))
+        SetErrorMessage(message.c_str());
+    }
+
+    void HandleOKCallback() override {
+      Nan::HandleScope scope;
+      prefetcher_->OperationFinished();
+      v8::Local<v8::Value> argv[1] = { Nan::Null() };
+      callback->Call(1, argv);
+    }
+
+    void HandleErrorCallback() override {
+      prefetcher_->OperationFinished();
+      Nan::AsyncWorker::HandleErrorCallback();
+    }
+
+   private:
+    RSPlaybackPrefetcher* prefetcher_;
+    uint64_t time_;
+  };
+
+  RSPlaybackPrefetcher() : pipeline_(nullptr), config_(nullptr),
+      device_(nullptr), error_(nullptr), capacity_(0), stop_(false),
+      finished_(false), seeking_(false), reading_(false), frames_read_(0),
+      frames_delivered_(0),
+      frames_dropped_(0), max_queued_(0), wait_time_total_(0),
+      wait_time_max_(0), pending_ops_(0), destroy_pending_(false) {}
+
+  ~RSPlaybackPrefetcher() {
+    DestroyMe();
+  }
+
+  void DestroyMe() {
+    if (error_) rs2_free_error(error_);
+    error_ = nullptr;
+    // Still used by a worker thread, destroy it once the operation returns.
+    if (pending_ops_) {
+      destroy_pending_ = true;
+      return;
+    }
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_ = true;
+    }
+    space_cv_.notify_all();
+    data_cv_.notify_all();
+    if (thread_.joinable()) thread_.join();
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      ReleaseQueued();
+    }
+    if (pipeline_) {
+      rs2_error* e = nullptr;
+      rs2_pipeline_stop(pipeline_, &e);
+      if (e) rs2_free_error(e);
+      rs2_delete_pipeline(pipeline_);
+    }
+    pipeline_ = nullptr;
+    if (config_) rs2_delete_config(config_);
+    config_ = nullptr;
+    if (device_) rs2_delete_device(device_);
+    device_ = nullptr;
+    destroy_pending_ = false;
+  }
+
+  void OperationFinished() {
+    pending_ops_--;
+    if (!pending_ops_ && destroy_pending_) DestroyMe();
+  }
+
+  // Must be called with mutex_ held
+  void ReleaseQueued() {
+    for (auto frames : queue_) rs2_release_frame(frames);
+    frames_dropped_ += queue_.size();
+    queue_.clear();
+  }
+
+  // Body of the prefetching thread
+  void Run() {
+    const int kPollTimeout = 100;  // in ms, how often stop_ is checked
+    // Time spent in try_wait_for_frames until the next frameset came out of
+    // the pipeline, over all the polls it took. The wait for space in the
+    // queue and the polls at the end of the file aren't part of it.
+    double wait_time = 0;
+    while (true) {
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        space_cv_.wait(lock, [this] {
+          return stop_ || (!seeking_ && queue_.size() < capacity_);
+        });
+        if (stop_) return;
+        reading_ = true;
+      }
+
+      rs2_error* e = nullptr;
+      rs2_frame* frames = nullptr;
+      auto start = std::chrono::steady_clock::now();
+      auto ok = rs2_pipeline_try_wait_for_frames(pipeline_, &frames,
+          kPollTimeout, &e);
+      wait_time += std::chrono::duration<double, std::milli>(
+          std::chrono::steady_clock::now() - start).count();
+      bool stopped = true;
+      if (!e && !ok) {
+        // The playback is stopped at the end of the file
+        stopped = rs2_playback_device_get_current_status(device_, &e) ==
+            RS2_PLAYBACK_STATUS_STOPPED;
+      }
+      std::lock_guard<std::mutex> lock(mutex_);
+      reading_ = false;
+      read_cv_.notify_all();
+      if (!e && !ok && !stopped) continue;
+      if (e || !ok) {
+        if (e) error_message_ = rs2_get_error_message(e);
+        if (e) rs2_free_error(e);
+        finished_ = true;
+        data_cv_.notify_all();
+        return;
+      }
+      queue_.push_back(frames);
+      frames_read_++;
+      wait_time_total_ += wait_time;
+      wait_time_max_ = std::max(wait_time_max_, wait_time);
+      wait_time = 0;
+      max_queued_ = std::max(max_queued_, queue_.size());
+      data_cv_.notify_one();
+    }
+  }
+
+  PopResult Pop(uint32_t timeout, rs2_frame** frames, std::string* message) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    data_cv_.wait_for(lock, std::chrono::milliseconds(timeout), [this] {
+      return !queue_.empty() || (finished_ && !seeking_) || stop_;
+    });
+    if (!queue_.empty()) {
+      *frames = queue_.front();
+      queue_.pop_front();
+      frames_delivered_++;
+      space_cv_.notify_one();
+      return kPopFrames;
+    }
+    // A seek in progress may restart the playback, it's not the end yet
+    if (!finished_ || seeking_) return kPopTimeout;
+    if (error_message_.empty()) return kPopEnd;
+    *message = error_message_;
+    return kPopError;
+  }
+
+  // Starts the pipeline and the thread again once the thread returned, the
+  // sensors of a playback device are stopped at the end of the file.
+  // Must be called with seek_mutex_ held and seeking_ set, the new thread
+  // waits for the seek to be done before it reads.
+  bool Restart(std::string* message) {
+    if (thread_.joinable()) thread_.join();
+    rs2_error* e = nullptr;
+    rs2_pipeline_stop(pipeline_, &e);
+    if (e) rs2_free_error(e);
+    e = nullptr;
+    if (device_) rs2_delete_device(device_);
+    device_ = nullptr;
+
+    auto profile = rs2_pipeline_start_with_config(pipeline_, config_, &e);
+    if (!e) {
+      device_ = rs2_pipeline_profile_get_device(profile, &e);
+      rs2_delete_pipeline_profile(profile);
+    }
+    if (!e) rs2_playback_device_set_real_time(device_, 0, &e);
+    if (e) {
+      *message = rs2_get_error_message(e);
+      rs2_free_error(e);
+      return false;
+    }
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      finished_ = false;
+      error_message_.clear();
+    }
+    thread_ = std::thread(&RSPlaybackPrefetcher::Run, this);
+    return true;
+  }
+
+  bool Seek(uint64_t time, std::string* message) {
+    // Seeks queued without waiting for each other run in parallel on the
+    // thread pool, and a restart replaces the thread and the device
+    std::lock_guard<std::mutex> seek_lock(seek_mutex_);
+    bool finished = false;
+    {
+      // The thread doesn't start a read while seeking_ is set, once the read
+      // in progress is done everything queued is from before the seek
+      std::unique_lock<std::mutex> lock(mutex_);
+      seeking_ = true;
+      read_cv_.wait(lock, [this] { return !reading_; });
+      ReleaseQueued();
+      finished = finished_;
+    }
+    bool ok = !finished || Restart(message);
+    if (ok) {
+      rs2_error* e = nullptr;
+      rs2_playback_seek(device_, time * 1000000, &e);
+      if (e) {
+        *message = rs2_get_error_message(e);
+        rs2_free_error(e);
+        ok = false;
+      }
+    }
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      seeking_ = false;
+    }
+    space_cv_.notify_all();
+    data_cv_.notify_all();
+    return ok;
+  }
+
+  // A config of the file and the streams the pipeline was started with, to
+  // restart it. The js config can be destroyed while the reader still runs.
+  static rs2_config* CopyConfig(rs2_pipeline_profile* profile,
+      rs2_device* device, rs2_error** e) {
+    auto file = rs2_playback_device_get_file_path(device, e);
+    if (*e) return nullptr;
+    rs2_config* config = rs2_create_config(e);
+    if (*e) return nullptr;
+    rs2_config_enable_device_from_file_repeat_option(config, file, 0, e);
+    rs2_stream_profile_list* list = nullptr;
+    if (!*e) list = rs2_pipeline_profile_get_streams(profile, e);
+    int count = 0;
+    if (!*e) count = rs2_get_stream_profiles_count(list, e);
+    for (int i = 0; !*e && i < count; i++) {
+      auto p = rs2_get_stream_profile(list, i, e);
+      rs2_stream stream = RS2_STREAM_ANY;
+      rs2_format format = RS2_FORMAT_ANY;
+      int index = 0, unique_id = 0, fps = 0, width = 0, height = 0;
+      if (!*e) {
+        rs2_get_stream_profile_data(p, &stream, &format, &index, &unique_id,
+            &fps, e);
+      }
+      if (!*e && rs2_stream_profile_is(p, RS2_EXTENSION_VIDEO_PROFILE, e))
+        rs2_get_video_stream_resolution(p, &width, &height, e);
+      if (!*e) {
+        rs2_config_enable_stream(config, stream, index, width, height, format,
+            fps, e);
+      }
+    }
+    if (list) rs2_delete_stream_profiles_list(list);
+    if (*e) {
+      rs2_delete_config(config);
+      return nullptr;
+    }
+    return config;
+  }
+
+  static void New(const Nan::FunctionCallbackInfo<v8::Value>& info) {
+    if (info.IsConstructCall()) {
+      RSPlaybackPrefetcher* obj = new RSPlaybackPrefetcher();
+      obj->Wrap(info.This());
+      info.GetReturnValue().Set(info.This());
+    }
+  }
+
+  static NAN_METHOD(Destroy) {
+    auto me = Nan::ObjectWrap::Unwrap<RSPlaybackPrefetcher>(info.Holder());
+    if (me) me->DestroyMe();
+    info.GetReturnValue().Set(Nan::Undefined());
+  }
+
+  static NAN_METHOD(Create) {
+    info.GetReturnValue().Set(Nan::False());
+    auto me = Nan::ObjectWrap::Unwrap<RSPlaybackPrefetcher>(info.Holder());
+    auto rsctx = Nan::ObjectWrap::Unwrap<RSContext>(info[0]->ToObject());
+    auto config = Nan::ObjectWrap::Unwrap<RSConfig>(info[1]->ToObject());
+    if (!me || !rsctx || !config || me->pipeline_) return;
+
+    me->pipeline_ = GetNativeResult<rs2_pipeline*>(rs2_create_pipeline,
+        &me->error_, rsctx->ctx_, &me->error_);
+    if (!me->pipeline_) return;
+
+    std::shared_ptr<rs2_pipeline_profile> profile(
+        GetNativeResult<rs2_pipeline_profile*>(rs2_pipeline_start_with_config,
+        &me->error_, me->pipeline_, config->config_, &me->error_),
+        rs2_delete_pipeline_profile);
+    if (!profile) return;
+
+    me->device_ = GetNativeResult<rs2_device*>(rs2_pipeline_profile_get_device,
+        &me->error_, profile.get(), &me->error_);
+    if (!me->device_) return;
+
+    CallNativeFunc(rs2_playback_device_set_real_time, &me->error_, me->device_,
+        0, &me->error_);
+    if (me->error_) return;
+
+    me->config_ = CopyConfig(profile.get(), me->device_, &me->error_);
+    if (!me->config_) return;
+
+    me->capacity_ = std::max<int64_t>(1, info[2]->IntegerValue());
+    me->start_time_ = std::chrono::steady_clock::now();
+    me->thread_ = std::thread(&RSPlaybackPrefetcher::Run, me);
+    info.GetReturnValue().Set(Nan::True());
+  }
+
+  static NAN_METHOD(NextAsync) {
+    info.GetReturnValue().Set(Nan::Undefined());
+    auto me = Nan::ObjectWrap::Unwrap<RSPlaybackPrefetcher>(info.Holder());
+    if (!me || !me->pipeline_ || me->destroy_pending_) return;
+
+    auto timeout = info[0]->IntegerValue();
+    RSFrameSet* target = nullptr;
+    if (info[2]->IsObject())
+      target = Nan::ObjectWrap::Unwrap<RSFrameSet>(info[2]->ToObject());
+    auto worker = new NextWorker(me, timeout, target,
+        new Nan::Callback(info[1].As<v8::Function>()));
+    worker->SaveToPersistent("prefetcher", info.Holder());
+    if (target) worker->SaveToPersistent("target", info[2]);
+    Nan::AsyncQueueWorker(worker);
+  }
+
+  static NAN_METHOD(SeekAsync) {
+    info.GetReturnValue().Set(Nan::Undefined());
+    auto me = Nan::ObjectWrap::Unwrap<RSPlaybackPrefetcher>(info.Holder());
+    if (!me || !me->pipeline_ || me->destroy_pending_) return;
+
+    uint64_t time = info[0]->IntegerValue();  // in ms
+    auto worker = new SeekWorker(me, time,
+        new Nan::Callback(info[1].As<v8::Function>()));
+    worker->SaveToPersistent("prefetcher", info.Holder());
+    Nan::AsyncQueueWorker(worker);
+  }
+
+  static NAN_METHOD(GetStatistics) {
+    info.GetReturnValue().Set(Nan::Undefined());
+    auto me = Nan::ObjectWrap::Unwrap<RSPlaybackPrefetcher>(info.Holder());
+    if (!me || !me->pipeline_) return;
+
+    std::lock_guard<std::mutex> lock(me->mutex_);
+    double elapsed = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - me->start_time_).count();
+    DictBase obj;
+    obj.SetMemberT("framesRead", static_cast<double>(me->frames_read_));
+    obj.SetMemberT("framesDelivered",
+        static_cast<double>(me->frames_delivered_));
+    obj.SetMemberT("framesDropped", static_cast<double>(me->frames_dropped_));
+    obj.SetMemberT("queued", static_cast<uint32_t>(me->queue_.size()));
+    obj.SetMemberT("maxQueued", static_cast<uint32_t>(me->max_queued_));
+    obj.SetMemberT("waitTimeTotal", me->wait_time_total_);
+    obj.SetMemberT("waitTimeMax", me->wait_time_max_);
+    obj.SetMemberT("elapsed", elapsed);
+    obj.SetMemberT("finished", me->finished_);
+    info.GetReturnValue().Set(obj.GetObject());
+  }
+
+ private:
+  static Nan::Persistent<v8::Function> constructor_;
+
+  rs2_pipeline* pipeline_;
+  rs2_config* config_;
+  rs2_device* device_;
+  rs2_error* error_;
+  size_t capacity_;
+  std::thread thread_;
+  // held by a seek, which can restart the thread and replace device_
+  std::mutex seek_mutex_;
+  // the members below are shared with the thread and guarded by mutex_
+  std::mutex mutex_;
+  std::condition_variable space_cv_;
+  std::condition_variable data_cv_;
+  std::condition_variable read_cv_;
+  std::deque<rs2_frame*> queue_;
+  bool stop_;
+  bool finished_;
+  bool seeking_;
+  bool reading_;
+  std::string error_message_;
+  uint64_t frames_read_;
+  uint64_t frames_delivered_;
+  uint64_t frames_dropped_;
+  size_t max_queued_;
+  double wait_time_total_;
+  double wait_time_max_;
+  std::chrono::steady_clock::time_point start_time_;
+  // used on the main thread only
+  uint32_t pending_ops_;
+  bool destroy_pending_;
+};
+
+Nan::Persistent<v8::Function> RSPlaybackPrefetcher::constructor_;
+
+///////////////////////////////////////////////////////////////////////////////
+// Streams from several pipelines at once. A native thread per pipeline waits
+// for its framesets, and the framesets of all the devices whose timestamps
+// are within a tolerance of each other are delivered together.
+class RSMultiDeviceCapture : public Nan::ObjectWrap {
+ public:
+  static void Init(v8::Local<v8::Object> exports) {
+    v8::Local<v8::FunctionTemplate> tpl = Nan::New<v8::FunctionTemplate>(New);
+    tpl->SetClassName(Nan::New("RSMultiDeviceCapture").ToLocalChecked());
+    tpl->InstanceTemplate()->SetInternalFieldCount(1);
+
+    Nan::SetPrototypeMethod(tpl, "destroy", Destroy);
+    Nan::SetPrototypeMethod(tpl, "create", Create);
+    Nan::SetPrototypeMethod(tpl, "nextAsync", NextAsync);
+    Nan::SetPrototypeMethod(tpl, "getStatistics", GetStatistics);
+
+    constructor_.Reset(tpl->GetFunction());
+    exports->Set(Nan::New("RSMultiDeviceCapture").ToLocalChecked(),
+        tpl->GetFunction());
+  }
+
+ private:
+  struct TimedFrames {
+    rs2_frame* frames;
+    double timestamp;  // in ms
+  };
+
+  struct DeviceState {
+    DeviceState() : pipeline(nullptr), received(0), dropped(0), grouped(0),
+        skew_total(0), skew_max(0) {}
+    rs2_pipeline* pipeline;
+    std::thread thread;
+    // guarded by RSMultiDeviceCapture::mutex_
+    std::deque<TimedFrames> queue;
+    uint64_t received;
+    uint64_t dropped;
+    uint64_t grouped;
+    double skew_total;
+    double skew_max;
+  };
+
+  // Waits for the next group in the libuv thread pool and passes it to the js
+  // callback as (error, RSFrameSet[], timestamp). On timeout, the array is
+  // undefined.
+  class NextWorker : public Nan::AsyncWorker {
+   public:
+    NextWorker(RSMultiDeviceCapture* capture, uint32_t timeout,
+        Nan::Callback* callback)
+        : Nan::AsyncWorker(callback), capture_(capture), timeout_(timeout),
+          timestamp_(0) {
+      capture_->pending_ops_++;
+    }
+
+    ~NextWorker() {
+      for (auto frames : group_) rs2_release_frame(frames);
+    }
+
+    void Execute() override {
+      std::string message;
+      if (!capture_->PopGroup(timeout_, &group_, &timestamp_, &message))
+        SetErrorMessage(message.c_str());
+    }
+
+    void HandleOKCallback() override {
+      Nan::HandleScope scope;
+      v8::Local<v8::Value> argv[3] = {
+        Nan::Null(), Nan::Undefined(), Nan::New(timestamp_)
+      };
+      if (group_.size()) {
+        v8::Local<v8::Array> array = Nan::New<v8::Array>(group_.size());
+        for (size_t i = 0; i < group_.size(); i++) {
+          array->Set(i, RSFrameSet::NewInstance(group_[i]));
+        }
+        group_.clear();
+        argv[1] = array;
+      }
+      capture_->OperationFinished();
+      callback->Call(3, argv);
+    }
+
+    void HandleErrorCallback() override {
+      capture_->OperationFinished();
+      Nan::AsyncWorker::HandleErrorCallback();
+    }
+
+   private:
+    RSMultiDeviceCapture* capture_;
+    uint32_t timeout_;
+    std::vector<rs2_frame*> group_;
+    double timestamp_;
+  };
+
+  RSMultiDeviceCapture() : error_(nullptr), tolerance_(0), queue_size_(1),
+      use_arrival_time_(false), stop_(false), groups_(0), pending_ops_(0),
+      destroy_pending_(false) {}
+
+  ~RSMultiDeviceCapture() {
+    DestroyMe();
+  }
+
+  void DestroyMe() {
+    if (error_) rs2_free_error(error_);
+    error_ = nullptr;
+    // Still used by a worker thread, destroy it once the operation returns.
+    if (pending_ops_) {
+      destroy_pending_ = true;
+      return;
+    }
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_ = true;
+    }
+    cv_.notify_all();
+    for (auto& device : devices_) {
+      if (device->thread.joinable()) device->thread.join();
+      for (auto& item : device->queue) rs2_release_frame(item.frames);
+      device->queue.clear();
+      if (device->pipeline) {
+        rs2_error* e = nullptr;
+        rs2_pipeline_stop(device->pipeline, &e);
+        if (e) rs2_free_error(e);
+        rs2_delete_pipeline(device->pipeline);
+      }
+    }
+    devices_.clear();
+    destroy_pending_ = false;
+  }
+
+  void OperationFinished() {
+    pending_ops_--;
+    if (!pending_ops_ && destroy_pending_) DestroyMe();
+  }
+
+  double Now() const {
+    return std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - start_time_).count();
+  }
+
+  // Body of the thread of each device
+  void Run(DeviceState* device) {
+    const int kPollTimeout = 100;  // in ms, how often stop_ is checked
+    while (true) {
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stop_) return;
+      }
+      rs2_error* e = nullptr;
+      rs2_frame* frames = nullptr;
+      if (!rs2_pipeline_try_wait_for_frames(device->pipeline, &frames,
+          kPollTimeout, &e)) {
+        if (e) {
+          std::lock_guard<std::mutex> lock(mutex_);
+          if (error_message_.empty())
+            error_message_ = rs2_get_error_message(e);
+          rs2_free_error(e);
+          cv_.notify_all();
+          return;
+        }
+        continue;
+      }
+      TimedFrames item = { frames, Now() };
+      if (!use_arrival_time_) {
+        rs2_frame* first = rs2_extract_frame(frames, 0, &e);
+        if (!e) item.timestamp = rs2_get_frame_timestamp(first, &e);
+        if (first) rs2_release_frame(first);
+        if (e) rs2_free_error(e);
+      }
+
+      std::lock_guard<std::mutex> lock(mutex_);
+      device->received++;
+      if (device->queue.size() >= queue_size_) {
+        // the consumer is too slow, keep the latest frames
+        rs2_release_frame(device->queue.front().frames);
+        device->queue.pop_front();
+        device->dropped++;
+      }
+      device->queue.push_back(item);
+      cv_.notify_all();
+    }
+  }
+
+  // Must be called with mutex_ held. Drops the frames that can't be matched
+  // anymore and returns true if the heads of all the queues form a group.
+  bool MatchHeads() {
+    while (true) {
+      double newest = -std::numeric_limits<double>::infinity();
+      for (auto& device : devices_) {
+        if (device->queue.empty()) return false;
+        newest = std::max(newest, device->queue.front().timestamp);
+      }
+      bool matched = true;
+      for (auto& device : devices_) {
+        if (newest - device->queue.front().timestamp > tolerance_) {
+          // older than any frame the other devices can still provide
+          rs2_release_frame(device->queue.front().frames);
+          device->queue.pop_front();
+          device->dropped++;
+          matched = false;
+        }
+      }
+      if (matched) return true;
+    }
+  }
+
+  bool PopGroup(uint32_t timeout, std::vector<rs2_frame*>* group,
+      double* timestamp, std::string* message) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.wait_for(lock, std::chrono::milliseconds(timeout), [this] {
+      return stop_ || !error_message_.empty() || MatchHeads();
+    });
+    if (!error_message_.empty()) {
+      *message = error_message_;
+      return false;
+    }
+    if (stop_ || !MatchHeads()) return true;
+
+    double oldest = std::numeric_limits<double>::infinity();
+    for (auto& device : devices_)
+      oldest = std::min(oldest, device->queue.front().timestamp);
+    for (auto& device : devices_) {
+      auto item = device->queue.front();
+      device->queue.pop_front();
+      double skew = item.timestamp - oldest;
+      device->grouped++;
+      device->skew_total += skew;
+      device->skew_max = std::max(device->skew_max, skew);
+      group->push_back(item.frames);
+    }
+    groups_++;
+    *timestamp = oldest;
+    return true;
+  }
+
+  static void New(const Nan::FunctionCallbackInfo<v8::Value>& info) {
+    if (info.IsConstructCall()) {
+      RSMultiDeviceCapture* obj = new RSMultiDeviceCapture();
+      obj->Wrap(info.This());
+      info.GetReturnValue().Set(info.This());
+    }
+  }
+
+  static NAN_METHOD(Destroy) {
+    auto me = Nan::ObjectWrap::Unwrap<RSMultiDeviceCapture>(info.Holder());
+    if (me) me->DestroyMe();
+    info.GetReturnValue().Set(Nan::Undefined());
+  }
+
+  // create(context, RSConfig[], tolerance, queueSize, useArrivalTime)
+  static NAN_METHOD(Create) {
+    info.GetReturnValue().Set(Nan::False());
+    auto me = Nan::ObjectWrap::Unwrap<RSMultiDeviceCapture>(info.Holder());
+    auto rsctx = Nan::ObjectWrap::Unwrap<RSContext>(info[0]->ToObject());
+    if (!me || !rsctx || !info[1]->IsArray() || me->devices_.size()) return;
+
+    auto configs = v8::Local<v8::Array>::Cast(info[1]);
+    me->tolerance_ = info[2]->NumberValue();
+    me->queue_size_ = std::max<int64_t>(1, info[3]->IntegerValue());
+    me->use_arrival_time_ = info[4]->BooleanValue();
+    me->start_time_ = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < configs->Length(); i++) {
+      auto config = Nan::ObjectWrap::Unwrap<RSConfig>(
+          configs->Get(i)->ToObject());
+      std::unique_ptr<DeviceState> device(new DeviceState());
+      device->pipeline = GetNativeResult<rs2_pipeline*>(rs2_create_pipeline,
+          &me->error_, rsctx->ctx_, &me->error_);
+      if (!device->pipeline) break;
+      me->devices_.push_back(std::move(device));
+
+      auto profile = GetNativeResult<rs2_pipeline_profile*>(
+          rs2_pipeline_start_with_config, &me->error_,
+          me->devices_.back()->pipeline, config->config_, &me->error_);
+      if (!profile) break;
+      rs2_delete_pipeline_profile(profile);
+    }
+    if (me->error_) {
+      me->DestroyMe();
+      return;
+    }
+    for (auto& device : me->devices_)
+      device->thread = std::thread(&RSMultiDeviceCapture::Run, me,
+          device.get());
+    info.GetReturnValue().Set(Nan::True());
+  }
+
+  static NAN_METHOD(NextAsync) {
+    info.GetReturnValue().Set(Nan::Undefined());
+    auto me = Nan::ObjectWrap::Unwrap<RSMultiDeviceCapture>(info.Holder());
+    if (!me || me->devices_.empty() || me->destroy_pending_) return;
+
+    auto timeout = info[0]->IntegerValue();
+    auto worker = new NextWorker(me, timeout,
+        new Nan::Callback(info[1].As<v8::Function>()));
+    worker->SaveToPersistent("capture", info.Holder());
+    Nan::AsyncQueueWorker(worker);
+  }
+
+  static NAN_METHOD(GetStatistics) {
+    info.GetReturnValue().Set(Nan::Undefined());
+    auto me = Nan::ObjectWrap::Unwrap<RSMultiDeviceCapture>(info.Holder());
+    if (!me || me->devices_.empty()) return;
+
+    std::lock_guard<std::mutex> lock(me->mutex_);
+    v8::Local<v8::Array> devices = Nan::New<v8::Array>(me->devices_.size());
+    for (size_t i = 0; i < me->devices_.size(); i++) {
+      auto& device = me->devices_[i];
+      DictBase obj;
+      obj.SetMemberT("received", static_cast<double>(device->received));
+      obj.SetMemberT("dropped", static_cast<double>(device->dropped));
+      obj.SetMemberT("queued", static_cast<uint32_t>(device->queue.size()));
+      obj.SetMemberT("skewMean", device->grouped ?
+          device->skew_total / device->grouped : 0.0);
+      obj.SetMemberT("skewMax", device->skew_max);
+      devices->Set(i, obj.GetObject());
+    }
+    DictBase obj;
+    obj.SetMemberT("groups", static_cast<double>(me->groups_));
+    obj.SetMember("devices", devices);
+    info.GetReturnValue().Set(obj.GetObject());
+  }
+
+ private:
+  static Nan::Persistent<v8::Function> constructor_;
+
+  rs2_error* error_;
+  double tolerance_;  // in ms
+  size_t queue_size_;
+  bool use_arrival_time_;
+  std::chrono::steady_clock::time_point start_time_;
+  std::vector<std::unique_ptr<DeviceState>> devices_;
+  // the members below are shared with the threads and guarded by mutex_
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  bool stop_;
+  std::string error_message_;
+  uint64_t groups_;
+  // used on the main thread only
+  uint32_t pending_ops_;
+  bool destroy_pending_;
+};
+
+Nan::Persistent<v8::Function> RSMultiDeviceCapture::constructor_;
+
 NAN_METHOD(RSConfig::Resolve) {
   info.GetReturnValue().Set(Nan::Undefined());
   auto me = Nan::ObjectWrap::Unwrap<RSConfig>(info.Holder());
@@ -4516,6 +5950,13 @@ NAN_METHOD(GetError) {
   info.GetReturnValue().Set(ErrorUtil::GetJSErrorObject());
 }
 
+NAN_METHOD(GetObjectStatistics) {
+  DictBase obj;
+  obj.SetMemberT("frameWrappers", RSFrame::live_instances_);
+  obj.SetMemberT("frameSetWrappers", RSFrameSet::live_instances_);
+  info.GetReturnValue().Set(obj.GetObject());
+}
+
 #define _FORCE_SET_ENUM(name) \
   Nan::DefineOwnProperty(exports, \
       Nan::New(#name).ToLocalChecked(), \
@@ -4531,6 +5972,8 @@ void InitModule(v8::Local<v8::Object> exports) {
       Nan::New<v8::FunctionTemplate>(RegisterErrorCallback)->GetFunction());
   exports->Set(Nan::New("getError").ToLocalChecked(),
       Nan::New<v8::FunctionTemplate>(GetError)->GetFunction());
+  exports->Set(Nan::New("getObjectStatistics").ToLocalChecked(),
+      Nan::New<v8::FunctionTemplate>(GetObjectStatistics)->GetFunction());
   // rs2_error* error = nullptr;
   // rs2_log_to_console(RS2_LOG_SEVERITY_DEBUG, &error);
 
@@ -4539,6 +5982,8 @@ void InitModule(v8::Local<v8::Object> exports) {
   RSPipelineProfile::Init(exports);
   RSConfig::Init(exports);
   RSPipeline::Init(exports);
+  RSPlaybackPrefetcher::Init(exports);
+  RSMultiDeviceCapture::Init(exports);
   RSFrameSet::Init(exports);
   RSSensor::Init(exports);
   RSDevice::Init(exports);
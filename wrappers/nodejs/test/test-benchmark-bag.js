@@ -0,0 +1,84 @@
+// Copyright (c) 2018 Intel Corporation. All rights reserved.
+// Use of this source code is governed by an Apache 2.0 license
+// that can be found in the LICENSE file.
+
+'use strict';
+
+/* global describe, it, before, after, afterEach */
+const assert = require('assert');
+const fs = require('fs');
+const os = require('os');
+const path = require('path');
+const generateBag = require('../benchmark/generate-bag.js');
+let rs2;
+try {
+  rs2 = require('node-librealsense');
+} catch (e) {
+  rs2 = require('../index.js');
+}
+
+// The benchmark plays a generated file by default, make sure librealsense reads it as written.
+// No device is needed
+const fileName = path.join(os.tmpdir(), 'node-librealsense-benchmark-test.bag');
+const frames = 10;
+describe('Benchmark bag test', function() {
+  before(function() {
+    generateBag(fileName, {frames: frames});
+  });
+
+  afterEach(function() {
+    rs2.cleanup();
+  });
+
+  after(function() {
+    if (fs.existsSync(fileName)) {
+      fs.unlinkSync(fileName);
+    }
+  });
+
+  it('Testing sensors, streams and depth units', () => {
+    const ctx = new rs2.Context();
+    const dev = ctx.loadDevice(fileName);
+    assert(dev instanceof rs2.PlaybackDevice);
+    const sensors = dev.querySensors();
+    assert.equal(sensors.length, 2);
+    assert(sensors[0] instanceof rs2.DepthSensor);
+    assert(Math.abs(sensors[0].depthScale - 0.001) < 1e-6);
+
+    const depth = sensors[0].getStreamProfiles();
+    assert.equal(depth.length, 1);
+    assert.equal(depth[0].streamType, rs2.stream.STREAM_DEPTH);
+    assert.equal(depth[0].format, rs2.format.FORMAT_Z16);
+    assert.equal(depth[0].fps, 30);
+    assert.equal(depth[0].width, 640);
+    assert.equal(depth[0].height, 480);
+
+    const color = sensors[1].getStreamProfiles();
+    assert.equal(color.length, 1);
+    assert.equal(color[0].streamType, rs2.stream.STREAM_COLOR);
+    assert.equal(color[0].format, rs2.format.FORMAT_RGB8);
+    assert.equal(color[0].width, 640);
+    assert.equal(color[0].height, 480);
+    ctx.unloadDevice(fileName);
+  });
+
+  it('Testing frame count and frame formats', () => {
+    const reader = new rs2.PlaybackReader(fileName);
+    let count = 0;
+    const readAll = () => reader.next().then((frameSet) => {
+      if (!frameSet) return;
+      count++;
+      assert.equal(frameSet.size, 2);
+      assert.equal(frameSet.depthFrame.format, rs2.format.FORMAT_Z16);
+      assert.equal(frameSet.depthFrame.getData().byteLength, 640 * 480 * 2);
+      assert.equal(frameSet.colorFrame.format, rs2.format.FORMAT_RGB8);
+      assert.equal(frameSet.colorFrame.getData().byteLength, 640 * 480 * 3);
+      frameSet.destroy();
+      return readAll();
+    });
+    return readAll().then(() => {
+      assert.equal(count, frames);
+      reader.destroy();
+    });
+  }).timeout(10000);
+});
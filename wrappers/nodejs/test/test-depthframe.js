@@ -187,6 +187,50 @@ describe('DepthFrame test', function() {
     assert.equal(typeof d, 'number');
   });
 
+  it('Testing method getRoiStatistics - valid argument', () => {
+    const layout = rs2.roiStatisticsLayout;
+    const rects = [{x: 0, y: 0, width: frame.width, height: frame.height},
+        {x: -10, y: -10, width: 5, height: 5}];
+    return frame.getRoiStatistics(rects).then((stats) => {
+      assert(stats instanceof Float64Array);
+      assert.equal(stats.length, 2 * layout.FIELD_COUNT);
+      if (stats[layout.COUNT]) {
+        assert(stats[layout.MIN] <= stats[layout.MEDIAN]);
+        assert(stats[layout.MEDIAN] <= stats[layout.MAX]);
+        assert(stats[layout.MIN] <= stats[layout.MEAN]);
+      }
+      // clipped out of the frame
+      assert.equal(stats[layout.FIELD_COUNT + layout.COUNT], 0);
+      assert(isNaN(stats[layout.FIELD_COUNT + layout.MIN]));
+    });
+  });
+
+  it('Testing method getRoiStatistics - invalid argument', () => {
+    assert.throws(() => {
+      frame.getRoiStatistics('dummy');
+    });
+    assert.throws(() => {
+      frame.getRoiStatistics(new Int32Array(4), new Float64Array(1));
+    });
+  });
+
+  it('Testing method deproject', () => {
+    return frame.deproject().then((points) => {
+      assert(points instanceof Float32Array);
+      assert.equal(points.length, frame.width * frame.height * 3);
+      const x = Math.floor(frame.width / 2);
+      const y = Math.floor(frame.height / 2);
+      const z = points[(y * frame.width + x) * 3 + 2];
+      assert(Math.abs(z - frame.getDistance(x, y)) < 1e-3);
+    });
+  });
+
+  it('Testing method deproject - invalid argument', () => {
+    assert.throws(() => {
+      frame.deproject(new Float32Array(1));
+    });
+  });
+
   it('Testing method destroy', () => {
     assert.doesNotThrow(() => {
       frame.destroy();
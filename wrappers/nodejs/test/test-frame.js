@@ -174,6 +174,34 @@ describe('Frame test', function() {
     }
   });
 
+  it('Testing method snapshot - 0 argument', () => {
+    const snapshot = frame.snapshot();
+    assert.equal(typeof snapshot.timestamp, 'number');
+    assert.equal(snapshot.timestamp, frame.timestamp);
+    assert.equal(snapshot.frameNumber, frame.frameNumber);
+    assert.equal(snapshot.timestampDomain, frame.timestampDomain);
+    assert.equal(snapshot.width, frame.width);
+    assert.equal(snapshot.height, frame.height);
+    assert.equal(snapshot.dataByteLength, frame.getData().byteLength);
+    assert.equal(snapshot.metadata.length, rs2.frame_metadata.FRAME_METADATA_COUNT);
+    for (let i = 0; i < rs2.frame_metadata.FRAME_METADATA_COUNT; i++) {
+      assert.equal(isNaN(snapshot.metadata[i]), !frame.supportsFrameMetadata(i));
+    }
+  });
+
+  it('Testing method snapshot - reuse target', () => {
+    const target = frame.snapshot();
+    const metadata = target.metadata;
+    assert.equal(frame.snapshot(target), target);
+    assert.equal(target.metadata, metadata);
+  });
+
+  it('Testing method snapshot - invalid argument', () => {
+    assert.throws(() => {
+      frame.snapshot('dummy');
+    });
+  });
+
   it('Testing method destroy', () => {
     assert.doesNotThrow(() => {
       frame.destroy();
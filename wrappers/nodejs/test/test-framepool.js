@@ -0,0 +1,68 @@
+// Copyright (c) 2018 Intel Corporation. All rights reserved.
+// Use of this source code is governed by an Apache 2.0 license
+// that can be found in the LICENSE file.
+
+'use strict';
+
+/* global describe, it, before, after */
+const assert = require('assert');
+let rs2;
+try {
+  rs2 = require('node-librealsense');
+} catch (e) {
+  rs2 = require('../index.js');
+}
+
+let pipeline;
+describe('FramePool test', function() {
+  before(function() {
+    pipeline = new rs2.Pipeline();
+    pipeline.start();
+  });
+
+  after(function() {
+    pipeline.destroy();
+    rs2.cleanup();
+  });
+
+  it('Testing constructor - invalid argument', () => {
+    assert.throws(() => {
+      new rs2.FramePool({maxFree: -1});
+    });
+    assert.throws(() => {
+      new rs2.FramePool('dummy');
+    });
+  });
+
+  it('Testing member statistics', () => {
+    const pool = new rs2.FramePool();
+    const stats = pool.statistics;
+    assert.equal(stats.created, 0);
+    assert.equal(stats.reused, 0);
+    assert.equal(stats.inUse, 0);
+    assert.equal(stats.free, 0);
+    assert.equal(typeof stats.nativeFrameWrappers, 'number');
+    assert.equal(typeof stats.nativeFrameSetWrappers, 'number');
+    pool.destroy();
+  });
+
+  it('Testing pipeline stream with pool', (done) => {
+    const pool = new rs2.FramePool({trackGC: true});
+    const stream = pipeline.createReadStream({pool: pool, highWaterMark: 1});
+    let count = 0;
+    stream.on('data', (frameSet) => {
+      assert(frameSet instanceof rs2.FrameSet);
+      assert(frameSet.depthFrame instanceof rs2.DepthFrame);
+      frameSet.release();
+      if (++count === 10) {
+        stream.destroy();
+        const stats = pool.statistics;
+        assert.equal(stats.inUse, 0);
+        assert(stats.created + stats.reused >= 10);
+        assert(stats.reused > 0);
+        pool.destroy();
+        done();
+      }
+    });
+  });
+});
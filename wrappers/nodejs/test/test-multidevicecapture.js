@@ -0,0 +1,80 @@
+// Copyright (c) 2018 Intel Corporation. All rights reserved.
+// Use of this source code is governed by an Apache 2.0 license
+// that can be found in the LICENSE file.
+
+'use strict';
+
+/* global describe, it, before, after */
+const assert = require('assert');
+let rs2;
+try {
+  rs2 = require('node-librealsense');
+} catch (e) {
+  rs2 = require('../index.js');
+}
+
+let serials;
+describe('MultiDeviceCapture test', function() {
+  before(function() {
+    const ctx = new rs2.Context();
+    serials = ctx.queryDevices().devices.map((dev) => dev.getCameraInfo().serialNumber);
+    assert(serials.length > 0); // Device must be connected
+  });
+
+  after(function() {
+    rs2.cleanup();
+  });
+
+  it('Testing constructor - invalid argument', () => {
+    assert.throws(() => {
+      new rs2.MultiDeviceCapture([]);
+    });
+    assert.throws(() => {
+      new rs2.MultiDeviceCapture([1]);
+    });
+    assert.throws(() => {
+      new rs2.MultiDeviceCapture(serials, {timestampSource: 'dummy'});
+    });
+    assert.throws(() => {
+      new rs2.MultiDeviceCapture(serials, {queueSize: 0});
+    });
+  });
+
+  it('Testing constructor - unknown device', () => {
+    assert.throws(() => {
+      new rs2.MultiDeviceCapture(['0000000000']);
+    });
+    // The devices are released by the failed capture, so they can be started again
+    const capture = new rs2.MultiDeviceCapture(serials);
+    capture.destroy();
+  });
+
+  it('Testing method next', () => {
+    const capture = new rs2.MultiDeviceCapture(serials, {timestampSource: 'arrival'});
+    return capture.next().then((group) => {
+      assert.equal(group.frameSets.length, serials.length);
+      group.frameSets.forEach((frameSet) => {
+        assert(frameSet instanceof rs2.FrameSet);
+        frameSet.destroy();
+      });
+      assert.equal(typeof group.timestamp, 'number');
+      const stats = capture.statistics;
+      assert.equal(stats.groups, 1);
+      assert.equal(stats.devices.length, serials.length);
+      assert.equal(typeof stats.devices[0].dropped, 'number');
+      assert.equal(typeof stats.devices[0].skewMax, 'number');
+      capture.destroy();
+    });
+  }).timeout(10000);
+
+  it('Testing method start', () => {
+    const capture = new rs2.MultiDeviceCapture(serials, {timestampSource: 'arrival'});
+    let count = 0;
+    return capture.start((group) => {
+      group.frameSets.forEach((frameSet) => frameSet.destroy());
+      if (++count === 5) capture.destroy();
+    }).then(() => {
+      assert.equal(count, 5);
+    });
+  }).timeout(10000);
+});
@@ -269,4 +269,24 @@ describe('Pipeline method test', () => {
       }
     });
   });
+
+  it('Testing method createReadStream', (done) => {
+    pipeline.start();
+    const stream = pipeline.createReadStream({highWaterMark: 2});
+    stream.once('data', (frameSet) => {
+      assert(frameSet instanceof rs2.FrameSet);
+      assert.equal(typeof frameSet.size, 'number');
+      assert.equal(stream.deliveredFrames, 1);
+      frameSet.destroy();
+      stream.destroy();
+      pipeline.stop();
+      done();
+    });
+  });
+
+  it('Testing method createReadStream - invalid option', () => {
+    assert.throws(() => {
+      pipeline.createReadStream({policy: 'dummy'});
+    });
+  });
 });
@@ -479,4 +479,116 @@ describe('PlayBackDevice test', function() {
       });
     });
   }).timeout(5000);
+
+  it('Testing method seekAsync - valid argument', () => {
+    return new Promise((resolve, reject) => {
+      startPlayback(fileName, (playbackDev, status, cnt) => {
+        playbackDev.seekAsync(0).then(() => {
+          assert.equal(typeof playbackDev.position, 'number');
+        });
+      }).then(() => {
+        resolve();
+      });
+    });
+  }).timeout(5000);
+
+  it('Testing method seekAsync - invalid argument', () => {
+    return new Promise((resolve, reject) => {
+      startPlayback(fileName, (playbackDev, status, cnt) => {
+        assert.throws(() => {
+          playbackDev.seekAsync('dummy');
+        });
+      }).then(() => {
+        resolve();
+      });
+    });
+  }).timeout(5000);
+
+  it('Testing PlaybackReader - read all framesets', () => {
+    const reader = new rs2.PlaybackReader(fileName, {prefetch: 4});
+    let count = 0;
+    const readAll = () => reader.next().then((frameSet) => {
+      if (!frameSet) return;
+      assert(frameSet instanceof rs2.FrameSet);
+      count++;
+      frameSet.destroy();
+      return readAll();
+    });
+    return readAll().then(() => {
+      const stats = reader.statistics;
+      assert(count > 0);
+      assert.equal(stats.framesDelivered, count);
+      assert.equal(stats.finished, true);
+      assert.equal(typeof stats.throughput, 'number');
+      assert.equal(typeof stats.waitTimeMean, 'number');
+      reader.destroy();
+    });
+  }).timeout(5000);
+
+  it('Testing PlaybackReader - seek', () => {
+    const reader = new rs2.PlaybackReader(fileName);
+    return reader.seek(0).then(() => reader.next()).then((frameSet) => {
+      assert(frameSet instanceof rs2.FrameSet);
+      frameSet.destroy();
+      reader.destroy();
+    });
+  }).timeout(5000);
+
+  it('Testing PlaybackReader - seek after the end of the file', () => {
+    const reader = new rs2.PlaybackReader(fileName);
+    const readAll = () => reader.next().then((frameSet) => {
+      if (!frameSet) return;
+      frameSet.destroy();
+      return readAll();
+    });
+    return readAll().then(() => reader.seek(0)).then(() => {
+      assert.equal(reader.statistics.finished, false);
+      return reader.next();
+    }).then((frameSet) => {
+      assert(frameSet instanceof rs2.FrameSet);
+      frameSet.destroy();
+      reader.destroy();
+    });
+  }).timeout(10000);
+
+  it('Testing PlaybackReader - concurrent seeks after the end of the file', () => {
+    const reader = new rs2.PlaybackReader(fileName);
+    const readAll = () => reader.next().then((frameSet) => {
+      if (!frameSet) return;
+      frameSet.destroy();
+      return readAll();
+    });
+    return readAll().then(() => Promise.all([reader.seek(0), reader.seek(0)])).then(() => {
+      return reader.next();
+    }).then((frameSet) => {
+      assert(frameSet instanceof rs2.FrameSet);
+      frameSet.destroy();
+      reader.destroy();
+    });
+  }).timeout(10000);
+
+  it('Testing PlaybackReader - seek after the end with a destroyed config', () => {
+    const config = new rs2.Config();
+    const reader = new rs2.PlaybackReader(fileName, {config: config});
+    config.destroy();
+    const readAll = () => reader.next().then((frameSet) => {
+      if (!frameSet) return;
+      frameSet.destroy();
+      return readAll();
+    });
+    return readAll().then(() => reader.seek(0)).then(() => reader.next()).then((frameSet) => {
+      assert(frameSet instanceof rs2.FrameSet);
+      frameSet.destroy();
+      reader.destroy();
+    });
+  }).timeout(10000);
+
+  it('Testing PlaybackReader - invalid argument', () => {
+    assert.throws(() => {
+      new rs2.PlaybackReader(fileName, {prefetch: 0});
+    });
+    assert.throws(() => {
+      new rs2.PlaybackReader(1);
+    });
+  });
 });
@@ -252,6 +252,22 @@ describe('Sensor test', function() {
     });
   }).timeout(5000);
 
+  it('Testing method createReadStream - ends when the sensor stops', (done) => {
+    const sensor = sensors[0];
+    sensor.open(sensor.getStreamProfiles()[0]);
+    const stream = sensor.createReadStream({highWaterMark: 2});
+    stream.once('data', (frame) => {
+      assert(frame instanceof rs2.Frame);
+      frame.destroy();
+      sensor.stop();
+    });
+    stream.on('error', done);
+    stream.on('end', () => {
+      sensor.close();
+      done();
+    });
+  }).timeout(5000);
+
   it('Testing method open, profileArray', () => {
     let dict = {};
     let sensor = sensors[0];
@@ -0,0 +1,76 @@
+// Copyright (c) 2018 Intel Corporation. All rights reserved.
+// Use of this source code is governed by an Apache 2.0 license
+// that can be found in the LICENSE file.
+
+'use strict';
+
+/* global describe, it, before, after */
+const assert = require('assert');
+let rs2;
+try {
+  rs2 = require('node-librealsense');
+} catch (e) {
+  rs2 = require('../index.js');
+}
+
+let pipeline;
+let frame;
+describe('SharedFramePool test', function() {
+  before(function() {
+    pipeline = new rs2.Pipeline();
+    pipeline.start();
+    const frameset = pipeline.waitForFrames();
+    frame = frameset.depthFrame;
+  });
+
+  after(function() {
+    pipeline.destroy();
+    rs2.cleanup();
+  });
+
+  it('Testing constructor - invalid argument', () => {
+    assert.throws(() => {
+      new rs2.SharedFramePool('dummy', 1);
+    });
+  });
+
+  it('Testing method write', () => {
+    const pool = new rs2.SharedFramePool(2, frame.dataByteLength);
+    const slot = pool.write(frame);
+    assert.equal(slot, 0);
+    assert(pool.isReady(slot));
+    const header = pool.getHeader(slot);
+    assert.equal(header.width, frame.width);
+    assert.equal(header.height, frame.height);
+    assert.equal(header.frameNumber, frame.frameNumber);
+    assert.equal(header.dataByteLength, frame.dataByteLength);
+    assert.deepEqual(pool.getData(slot), new Uint8Array(frame.data.buffer));
+  });
+
+  it('Testing method write - pool exhausted', () => {
+    const pool = new rs2.SharedFramePool(1, frame.dataByteLength);
+    assert.equal(pool.write(frame), 0);
+    assert.equal(pool.write(frame), -1);
+    assert.equal(pool.droppedFrames, 1);
+    pool.release(0);
+    assert.equal(pool.busySlots, 0);
+    assert.equal(pool.write(frame), 0);
+  });
+
+  it('Testing method write - slot too small', () => {
+    const pool = new rs2.SharedFramePool(1, 1);
+    assert.throws(() => {
+      pool.write(frame);
+    });
+    assert.equal(pool.busySlots, 0);
+  });
+
+  it('Testing SharedFrameSlots from handles', () => {
+    const pool = new rs2.SharedFramePool(2, frame.dataByteLength);
+    const slot = pool.write(frame);
+    const slots = new rs2.SharedFrameSlots(pool.handles);
+    assert.equal(slots.getHeader(slot).timestamp, frame.timestamp);
+    slots.release(slot);
+    assert(!pool.isReady(slot));
+  });
+});
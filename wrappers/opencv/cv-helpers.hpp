@@ -4,40 +4,436 @@
 #pragma once
 
 #include <librealsense2/rs.hpp> // Include RealSense Cross Platform API
+#include <librealsense2/rsutil.h>
 #include <opencv2/opencv.hpp>   // Include OpenCV API
+#include <algorithm>
+#include <cmath>
 #include <exception>
+#include <vector>
 
-// Convert rs2::frame to cv::Mat
-cv::Mat frame_to_mat(const rs2::frame& f)
+// cv::Mat allocator that keeps an rs2::frame alive for as long as a Mat refers to its data.
+// Mats created through it point straight at the frame's buffer, which librealsense may share with
+// other consumers of the frame: treat them as read-only and write results into separate Mats.
+// Same approach as the allocator OpenCV's python bindings use to wrap numpy arrays.
+class frame_mat_allocator : public cv::MatAllocator
+{
+public:
+#if CV_VERSION_MAJOR >= 4
+    typedef cv::AccessFlag access_flag;
+#else
+    typedef int access_flag;
+#endif
+
+    // Returns a Mat that views the data of f and holds a reference to f
+    cv::Mat wrap(const rs2::frame& f, int rows, int cols, int type, size_t step) const
+    {
+        cv::Mat m(rows, cols, type, const_cast<void*>(f.get_data()), step);
+
+        auto u = new cv::UMatData(this);
+        u->data = u->origdata = m.data;
+        u->size = rows * step;
+        u->userdata = new rs2::frame(f);
+        m.u = u;
+        m.addref();
+        m.allocator = const_cast<frame_mat_allocator*>(this);
+        return m;
+    }
+
+    // New buffers (eg when a wrapping Mat is re-created with another size) are plain OpenCV memory
+    cv::UMatData* allocate(int dims, const int* sizes, int type, void* data, size_t* step,
+                           access_flag flags, cv::UMatUsageFlags usage) const override
+    {
+        return cv::Mat::getDefaultAllocator()->allocate(dims, sizes, type, data, step, flags, usage);
+    }
+    bool allocate(cv::UMatData* u, access_flag access, cv::UMatUsageFlags usage) const override
+    {
+        return cv::Mat::getDefaultAllocator()->allocate(u, access, usage);
+    }
+
+    void deallocate(cv::UMatData* u) const override
+    {
+        if (!u) return;
+        CV_Assert(u->urefcount >= 0);
+        CV_Assert(u->refcount >= 0);
+        if (u->refcount == 0)
+        {
+            delete static_cast<rs2::frame*>(u->userdata);
+            delete u;
+        }
+    }
+
+    static const frame_mat_allocator& instance()
+    {
+        static frame_mat_allocator allocator;
+        return allocator;
+    }
+};
+
+// Small pool of output Mats for conversions, so that converting every frame of a stream
+// doesn't allocate a new image every time. A Mat is handed out again once no one else
+// holds a reference to it.
+class mat_pool
+{
+public:
+    explicit mat_pool(size_t capacity = 4) : _capacity(capacity) {}
+
+    cv::Mat acquire(int rows, int cols, int type)
+    {
+        for (auto& m : _mats)
+        {
+            if (m.rows == rows && m.cols == cols && m.type() == type && m.u && m.u->refcount == 1)
+                return m;
+        }
+        cv::Mat m(rows, cols, type);
+        if (_mats.size() < _capacity) _mats.push_back(m);
+        return m;
+    }
+
+private:
+    size_t _capacity;
+    std::vector<cv::Mat> _mats;
+};
+
+// Wraps rs2::frame in a cv::Mat without copying, for every format librealsense produces.
+// Channels are kept in the frame's order (RGB8 stays RGB, YUYV is 2 channels per pixel).
+// The Mat keeps the frame alive, and must not be written to (see frame_mat_allocator).
+cv::Mat frame_to_mat_view(const rs2::frame& f)
 {
     using namespace cv;
     using namespace rs2;
 
-    auto vf = f.as<video_frame>();
-    const int w = vf.get_width();
-    const int h = vf.get_height();
+    int w, h, stride;
+    if (auto vf = f.as<video_frame>())
+    {
+        w = vf.get_width();
+        h = vf.get_height();
+        stride = vf.get_stride_in_bytes();
+    }
+    else if (auto vp = f.get_profile().as<video_stream_profile>()) // points
+    {
+        w = vp.width();
+        h = vp.height();
+        stride = 0;
+    }
+    else throw std::runtime_error("Only image frames can be converted to cv::Mat");
+
+    int type;
+    switch (f.get_profile().format())
+    {
+    case RS2_FORMAT_Z16: case RS2_FORMAT_Y16:
+    case RS2_FORMAT_DISPARITY16: case RS2_FORMAT_RAW16: type = CV_16UC1; break;
+    case RS2_FORMAT_Y8: case RS2_FORMAT_RAW8:            type = CV_8UC1; break;
+    case RS2_FORMAT_YUYV: case RS2_FORMAT_UYVY:          type = CV_8UC2; break;
+    case RS2_FORMAT_RGB8: case RS2_FORMAT_BGR8:          type = CV_8UC3; break;
+    case RS2_FORMAT_RGBA8: case RS2_FORMAT_BGRA8:        type = CV_8UC4; break;
+    case RS2_FORMAT_XYZ32F:                              type = CV_32FC3; break;
+    case RS2_FORMAT_DISPARITY32:                         type = CV_32FC1; break;
+    default: throw std::runtime_error("Frame format is not supported yet!");
+    }
+    if (stride == 0) stride = w * CV_ELEM_SIZE(type);
+    return frame_mat_allocator::instance().wrap(f, h, w, type, stride);
+}
+
+// Convert rs2::frame to cv::Mat, with color in OpenCV's BGR / BGRA order.
+// Formats OpenCV understands as-is are wrapped without copying (see frame_to_mat_view),
+// others are converted into a pooled Mat. The frame's own buffer is never modified.
+cv::Mat frame_to_mat(const rs2::frame& f)
+{
+    using namespace cv;
 
-    if (f.get_profile().format() == RS2_FORMAT_BGR8)
+    static thread_local mat_pool pool;
+    auto view = frame_to_mat_view(f);
+
+    int code, type;
+    switch (f.get_profile().format())
     {
-        return Mat(Size(w, h), CV_8UC3, (void*)f.get_data(), Mat::AUTO_STEP);
+    case RS2_FORMAT_RGB8:  code = COLOR_RGB2BGR;       type = CV_8UC3; break;
+    case RS2_FORMAT_RGBA8: code = COLOR_RGBA2BGRA;     type = CV_8UC4; break;
+    case RS2_FORMAT_YUYV:  code = COLOR_YUV2BGR_YUYV;  type = CV_8UC3; break;
+    case RS2_FORMAT_UYVY:  code = COLOR_YUV2BGR_UYVY;  type = CV_8UC3; break;
+    default: return view;
     }
-    else if (f.get_profile().format() == RS2_FORMAT_RGB8)
+    auto out = pool.acquire(view.rows, view.cols, type);
+    cvtColor(view, out, code);
+    return out;
+}
+
+// Converts Z16 depth frames to CV_32F distances in meters in a single pass.
+// The depth units of the sensor are looked up when the stream profile changes instead of on
+// every frame, and whole images are written into pooled Mats.
+class depth_to_meters
+{
+public:
+    depth_to_meters() : _profile_id(-1), _scale(0.f), _pool(2) {}
+
+    float depth_scale(const rs2::depth_frame& f)
+    {
+        auto profile = f.get_profile();
+        if (profile.unique_id() != _profile_id)
+        {
+            rs2_error* e = nullptr;
+            auto sensor = rs2_get_frame_sensor(f.get(), &e);
+            rs2::error::handle(e);
+            _scale = rs2_get_depth_scale(sensor, &e);
+            rs2_delete_sensor(sensor);
+            rs2::error::handle(e);
+            _profile_id = profile.unique_id();
+        }
+        return _scale;
+    }
+
+    cv::Mat operator()(const rs2::depth_frame& f)
     {
-        auto r = Mat(Size(w, h), CV_8UC3, (void*)f.get_data(), Mat::AUTO_STEP);
-        cvtColor(r, r, CV_RGB2BGR);
+        auto depth = view(f);
+        auto meters = _pool.acquire(depth.rows, depth.cols, CV_32FC1);
+        depth.convertTo(meters, CV_32F, depth_scale(f));
+        return meters;
+    }
+
+    // Converts only the pixels inside roi, clipped to the frame.
+    // Useful when just a few regions of the image are of interest (eg detections)
+    cv::Mat operator()(const rs2::depth_frame& f, cv::Rect roi)
+    {
+        auto depth = view(f);
+        roi &= cv::Rect(0, 0, depth.cols, depth.rows);
+        cv::Mat meters;
+        depth(roi).convertTo(meters, CV_32F, depth_scale(f));
+        return meters;
+    }
+
+private:
+    static cv::Mat view(const rs2::depth_frame& f)
+    {
+        if (f.get_profile().format() != RS2_FORMAT_Z16)
+            throw std::runtime_error("Only Z16 depth frames can be converted to meters");
+        return frame_to_mat_view(f);
+    }
+
+    int _profile_id;
+    float _scale;
+    mat_pool _pool;
+};
+
+// Depth statistics of a region of the color image, in meters. All 0 if no depth pixel maps into the region
+struct roi_depth
+{
+    int count; // number of valid depth pixels that map into the region
+    float min, max, mean, median;
+};
+
+// Alternative to rs2::align for when depth is only needed inside a few regions of the color image
+// (eg the boxes of a detector). Instead of mapping every depth pixel to the color image, only the
+// depth pixels that can land inside each region are projected, so the cost scales with the area
+// of the regions rather than with the size of the frame.
+class roi_aligner
+{
+public:
+    // Depth outside [min_z, max_z] meters is ignored, the range also bounds the part of the depth
+    // image that is searched for each region
+    roi_aligner(float min_z = 0.1f, float max_z = 10.f)
+        : _min_z(min_z), _max_z(max_z), _depth_id(-1), _color_id(-1) {}
+
+    std::vector<roi_depth> process(const rs2::depth_frame& depth, const rs2::video_stream_profile& color,
+                                   const std::vector<cv::Rect>& boxes)
+    {
+        update(depth.get_profile().as<rs2::video_stream_profile>(), color);
+        const float scale = _to_meters.depth_scale(depth);
+        const auto data = reinterpret_cast<const uint16_t*>(depth.get_data());
+        const int stride = depth.get_stride_in_bytes() / sizeof(uint16_t);
+
+        std::vector<roi_depth> result;
+        for (auto&& box : boxes)
+        {
+            _values.clear();
+            auto area = search_area(box);
+            for (int y = area.y; y < area.y + area.height; ++y)
+            {
+                auto row = data + y * stride;
+                for (int x = area.x; x < area.x + area.width; ++x)
+                {
+                    const float z = row[x] * scale;
+                    if (z < _min_z || z > _max_z) continue; // also skips pixels without depth
+
+                    // Same mapping as rs2::align
+                    float pixel[2] = { float(x), float(y) }, point[3], color_point[3], color_pixel[2];
+                    rs2_deproject_pixel_to_point(point, &_depth_intrin, pixel, z);
+                    rs2_transform_point_to_point(color_point, &_depth_to_color, point);
+                    rs2_project_point_to_pixel(color_pixel, &_color_intrin, color_point);
+                    if (box.contains(cv::Point(int(color_pixel[0] + 0.5f), int(color_pixel[1] + 0.5f))))
+                        _values.push_back(z);
+                }
+            }
+            result.push_back(stats(_values));
+        }
+        return result;
+    }
+
+    roi_depth process(const rs2::depth_frame& depth, const rs2::video_stream_profile& color, const cv::Rect& box)
+    {
+        return process(depth, color, std::vector<cv::Rect>{ box }).front();
+    }
+
+private:
+    void update(const rs2::video_stream_profile& depth, const rs2::video_stream_profile& color)
+    {
+        if (depth.unique_id() == _depth_id && color.unique_id() == _color_id) return;
+        _depth_intrin = depth.get_intrinsics();
+        _color_intrin = color.get_intrinsics();
+        _depth_to_color = depth.get_extrinsics_to(color);
+        _color_to_depth = color.get_extrinsics_to(depth);
+        _depth_id = depth.unique_id();
+        _color_id = color.unique_id();
+    }
+
+    // Point at depth z that process() maps to the color pixel. rs2_deproject_pixel_to_point doesn't
+    // always undo the distortion the way rs2_project_point_to_pixel applies it (and can't undo a forward
+    // distortion at all), so its result is refined until projecting it gives the pixel back
+    void deproject_color(float point[3], const float pixel[2], float z) const
+    {
+        rs2_intrinsics intrin = _color_intrin;
+        if (intrin.model == RS2_DISTORTION_MODIFIED_BROWN_CONRADY) intrin.model = RS2_DISTORTION_NONE;
+        rs2_deproject_pixel_to_point(point, &intrin, pixel, z);
+        for (int i = 0; i < 10; ++i)
+        {
+            float projected[2];
+            rs2_project_point_to_pixel(projected, &_color_intrin, point);
+            point[0] += (pixel[0] - projected[0]) / _color_intrin.fx * z;
+            point[1] += (pixel[1] - projected[1]) / _color_intrin.fy * z;
+        }
+    }
+
+    // Bounding box of the depth pixels that can map into box: where the edges of the box are seen at the
+    // nearest and at the farthest depth. With lens distortion the edges are curves in the depth image, so
+    // they are sampled instead of just taking the corners, and the margin covers what lies between samples
+    cv::Rect search_area(const cv::Rect& box) const
+    {
+        const int margin = 2;
+        const int samples = 8; // per edge
+        float min_x = INFINITY, min_y = INFINITY, max_x = -INFINITY, max_y = -INFINITY;
+        const float x0 = float(box.x), y0 = float(box.y);
+        const float x1 = float(box.x + box.width), y1 = float(box.y + box.height);
+        for (int i = 0; i <= samples; ++i)
+        {
+            const float x = x0 + (x1 - x0) * i / samples, y = y0 + (y1 - y0) * i / samples;
+            const float edges[4][2] = { { x, y0 }, { x, y1 }, { x0, y }, { x1, y } };
+            for (auto&& pixel : edges)
+            {
+                for (float z : { _min_z, _max_z })
+                {
+                    float color_point[3], point[3], depth_pixel[2];
+                    deproject_color(color_point, pixel, z);
+                    rs2_transform_point_to_point(point, &_color_to_depth, color_point);
+                    rs2_project_point_to_pixel(depth_pixel, &_depth_intrin, point);
+                    min_x = std::min(min_x, depth_pixel[0]); max_x = std::max(max_x, depth_pixel[0]);
+                    min_y = std::min(min_y, depth_pixel[1]); max_y = std::max(max_y, depth_pixel[1]);
+                }
+            }
+        }
+        cv::Rect area(cv::Point(int(std::floor(min_x)) - margin, int(std::floor(min_y)) - margin),
+                      cv::Point(int(std::ceil(max_x)) + margin, int(std::ceil(max_y)) + margin));
+        return area & cv::Rect(0, 0, _depth_intrin.width, _depth_intrin.height);
+    }
+
+    static roi_depth stats(std::vector<float>& values)
+    {
+        roi_depth r = { 0, 0.f, 0.f, 0.f, 0.f };
+        if (values.empty()) return r;
+        r.count = int(values.size());
+        auto range = std::minmax_element(values.begin(), values.end());
+        r.min = *range.first;
+        r.max = *range.second;
+        double sum = 0;
+        for (auto v : values) sum += v;
+        r.mean = float(sum / values.size());
+        auto mid = values.begin() + values.size() / 2;
+        std::nth_element(values.begin(), mid, values.end());
+        r.median = *mid;
         return r;
     }
-    else if (f.get_profile().format() == RS2_FORMAT_Z16)
+
+    float _min_z, _max_z;
+    int _depth_id, _color_id;
+    rs2_intrinsics _depth_intrin, _color_intrin;
+    rs2_extrinsics _depth_to_color, _color_to_depth;
+    depth_to_meters _to_meters;
+    std::vector<float> _values;
+};
+
+// Builds the initial mask for cv::grabCut straight from Z16 depth (aligned to the color image):
+// GC_FGD where depth is closer than near_m meters, GC_BGD where it is farther than far_m,
+// and GC_PR_BGD elsewhere, including pixels without depth.
+// The near and far regions are thresholded together in a single pass over the depth, and
+// each is cleaned up by closing small holes and then eroding it (the dilation uses the
+// smaller of the two kernels), so that only confident pixels keep a definite label.
+class grabcut_trimap
+{
+public:
+    grabcut_trimap(float near_m, float far_m, int erosion_size = 3)
+        : _near_m(near_m), _far_m(far_m), _pool(2)
     {
-        return Mat(Size(w, h), CV_16UC1, (void*)f.get_data(), Mat::AUTO_STEP);
+        auto gen_element = [](int size)
+        {
+            return cv::getStructuringElement(cv::MORPH_RECT, cv::Size(size + 1, size + 1), cv::Point(size, size));
+        };
+        _dilate_kernel = gen_element(erosion_size);
+        _erode_kernel = gen_element(erosion_size * 2);
+    }
+
+    // The result can be passed to cv::grabCut, which modifies it
+    cv::Mat operator()(const rs2::depth_frame& f)
+    {
+        if (f.get_profile().format() != RS2_FORMAT_Z16)
+            throw std::runtime_error("Only Z16 depth frames can be segmented");
+        auto depth = frame_to_mat_view(f);
+
+        // Thresholds in depth units. Pixels without depth are 0 and never count as near
+        const float scale = _to_meters.depth_scale(f);
+        const uint16_t near_units = to_units(_near_m / scale);
+        const uint16_t far_units = to_units(_far_m / scale);
+
+        _near.create(depth.size(), CV_8UC1);
+        _far.create(depth.size(), CV_8UC1);
+        for (int y = 0; y < depth.rows; y++)
+        {
+            auto d = depth.ptr<uint16_t>(y);
+            auto near = _near.ptr<uint8_t>(y);
+            auto far = _far.ptr<uint8_t>(y);
+            // No branches, so that the compiler can vectorize the loop
+            for (int x = 0; x < depth.cols; x++)
+            {
+                near[x] = uint8_t(-int((d[x] != 0) & (d[x] < near_units)));
+                far[x] = uint8_t(-int(d[x] > far_units));
+            }
+        }
+        cv::dilate(_near, _near, _dilate_kernel);
+        cv::erode(_near, _near, _erode_kernel);
+        cv::dilate(_far, _far, _dilate_kernel);
+        cv::erode(_far, _far, _erode_kernel);
+
+        auto mask = _pool.acquire(depth.rows, depth.cols, CV_8UC1);
+        for (int y = 0; y < depth.rows; y++)
+        {
+            auto near = _near.ptr<uint8_t>(y);
+            auto far = _far.ptr<uint8_t>(y);
+            auto m = mask.ptr<uint8_t>(y);
+            for (int x = 0; x < depth.cols; x++)
+                m[x] = near[x] ? uint8_t(cv::GC_FGD) : far[x] ? uint8_t(cv::GC_BGD) : uint8_t(cv::GC_PR_BGD);
+        }
+        return mask;
     }
-    else if (f.get_profile().format() == RS2_FORMAT_Y8)
+
+private:
+    static uint16_t to_units(float units)
     {
-        return Mat(Size(w, h), CV_8UC1, (void*)f.get_data(), Mat::AUTO_STEP);
+        return uint16_t(std::min(std::max(units, 1.f), 65535.f));
     }
 
-    throw std::runtime_error("Frame format is not supported yet!");
-}
+    float _near_m, _far_m;
+    cv::Mat _dilate_kernel, _erode_kernel;
+    cv::Mat _near, _far;
+    depth_to_meters _to_meters;
+    mat_pool _pool;
+};
 
 // Converts depth frame to a matrix of doubles with distances in meters
 cv::Mat depth_frame_to_meters(const rs2::pipeline& pipe, const rs2::depth_frame& f)
@@ -45,13 +441,11 @@ cv::Mat depth_frame_to_meters(const rs2::pipeline& pipe, const rs2::depth_frame&
     using namespace cv;
     using namespace rs2;
 
-    Mat dm = frame_to_mat(f);
-    dm.convertTo(dm, CV_64F);
     auto depth_scale = pipe.get_active_profile()
         .get_device()
         .first<depth_sensor>()
         .get_depth_scale();
-    dm = dm * depth_scale;
+    Mat dm;
+    frame_to_mat_view(f).convertTo(dm, CV_64F, depth_scale);
     return dm;
 }
-
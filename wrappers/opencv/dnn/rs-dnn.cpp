@@ -5,6 +5,7 @@
 #include <opencv2/dnn.hpp>
 #include <librealsense2/rs.hpp>
 #include "../cv-helpers.hpp"
+#include "../pipeline-helpers.hpp"
 
 const size_t inWidth      = 300;
 const size_t inHeight     = 300;
@@ -32,7 +33,6 @@ int main(int argc, char** argv) try
     auto config = pipe.start();
     auto profile = config.get_stream(RS2_STREAM_COLOR)
                          .as<video_stream_profile>();
-    rs2::align align_to(RS2_STREAM_COLOR);
 
     Size cropSize;
     if (profile.width() / (float)profile.height() > WHRatio)
@@ -50,88 +50,144 @@ int main(int argc, char** argv) try
                     (profile.height() - cropSize.height) / 2),
               cropSize);
 
+    // Depth is only needed inside the detections, so instead of aligning
+    // the whole depth frame to color only the detected objects are mapped
+    roi_aligner aligner;
+
+    // The work is split into stages running on their own threads:
+    //   capture -> preprocess -> inference
+    //         \__________________________ render (main thread)
+    // Every link only holds the newest item, so the display keeps up with the camera
+    // even when the network is slower, showing the most recent detections it has.
+    frame_queue display_queue(1), detect_queue(1);
+    latest<Mat> blobs;
+    latest<Mat> detections;
+
+    // Capture only hands the frames on, so it reports the frame rate without a latency
+    stage capture("capture", [&](stage_stats& stats)
+    {
+        frameset data;
+        if (!pipe.try_wait_for_frames(&data, 100)) return;
+        display_queue.enqueue(data);
+        detect_queue.enqueue(data);
+        stats.add();
+    });
+
+    stage preprocess("preprocess", [&](stage_stats& stats)
+    {
+        frameset data;
+        if (!detect_queue.try_wait_for_frame(&data, 100)) return;
+        auto timer = stats.time();
+        // Convert RealSense frame to OpenCV matrix, and then to a batch of images
+        auto color_mat = frame_to_mat(data.get_color_frame());
+        blobs.publish(blobFromImage(color_mat, inScaleFactor,
+                                    Size(inWidth, inHeight), meanVal, false));
+    });
+
+    stage inference("inference", [&](stage_stats& stats)
+    {
+        Mat inputBlob;
+        if (!blobs.take(inputBlob, std::chrono::milliseconds(10))) return;
+        auto timer = stats.time();
+        net.setInput(inputBlob, "data"); //set the network input
+        Mat detection = net.forward("detection_out"); //compute output
+
+        // The network may reuse its output buffer, so the detections are copied
+        detections.publish(Mat(detection.size[2], detection.size[3], CV_32F, detection.ptr<float>()).clone());
+    });
+
+    stage_stats render("render");
+    auto last_report = stage_stats::clock::now();
+
     const auto window_name = "Display Image";
     namedWindow(window_name, WINDOW_AUTOSIZE);
 
     while (cvGetWindowHandle(window_name))
     {
-        // Wait for the next set of frames
-        auto data = pipe.wait_for_frames();
-        // Make sure the frames are spatially aligned
-        data = align_to.process(data);
-
-        auto color_frame = data.get_color_frame();
-        auto depth_frame = data.get_depth_frame();
-
-        // If we only received new depth frame, 
-        // but the color did not update, continue
-        static int last_frame_number = 0;
-        if (color_frame.get_frame_number() == last_frame_number) continue;
-        last_frame_number = color_frame.get_frame_number();
-
-        // Convert RealSense frame to OpenCV matrix:
-        auto color_mat = frame_to_mat(color_frame);
-        auto depth_mat = depth_frame_to_meters(pipe, depth_frame);
-
-        Mat inputBlob = blobFromImage(color_mat, inScaleFactor,
-                                      Size(inWidth, inHeight), meanVal, false); //Convert Mat to batch of images
-        net.setInput(inputBlob, "data"); //set the network input
-        Mat detection = net.forward("detection_out"); //compute output
+        // Stop if a stage failed, with the error it failed with
+        capture.check();
+        preprocess.check();
+        inference.check();
 
-        Mat detectionMat(detection.size[2], detection.size[3], CV_32F, detection.ptr<float>());
+        frameset data;
+        if (display_queue.poll_for_frame(&data))
+        {
+            auto timer = render.time();
 
-        // Crop both color and depth frames
-        color_mat = color_mat(crop);
-        depth_mat = depth_mat(crop);
+            auto color_frame = data.get_color_frame();
+            auto depth_frame = data.get_depth_frame();
 
-        float confidenceThreshold = 0.8f;
-        for(int i = 0; i < detectionMat.rows; i++)
-        {
-            float confidence = detectionMat.at<float>(i, 2);
+            // Crop the color frame
+            Mat color_mat = frame_to_mat(color_frame)(crop);
+            // The frame may be shared with the other stages, draw on a copy
+            color_mat = color_mat.clone();
 
-            if(confidence > confidenceThreshold)
+            Mat detectionMat; // stays empty until the first inference is done
+            detections.peek(detectionMat);
+
+            float confidenceThreshold = 0.8f;
+            for(int i = 0; i < detectionMat.rows; i++)
             {
-                size_t objectClass = (size_t)(detectionMat.at<float>(i, 1));
-
-                int xLeftBottom = static_cast<int>(detectionMat.at<float>(i, 3) * color_mat.cols);
-                int yLeftBottom = static_cast<int>(detectionMat.at<float>(i, 4) * color_mat.rows);
-                int xRightTop = static_cast<int>(detectionMat.at<float>(i, 5) * color_mat.cols);
-                int yRightTop = static_cast<int>(detectionMat.at<float>(i, 6) * color_mat.rows);
-
-                Rect object((int)xLeftBottom, (int)yLeftBottom,
-                            (int)(xRightTop - xLeftBottom),
-                            (int)(yRightTop - yLeftBottom));
-
-                object = object  & Rect(0, 0, depth_mat.cols, depth_mat.rows);
-
-                // Calculate mean depth inside the detection region
-                // This is a very naive way to estimate objects depth
-                // but it is intended to demonstrate how one might 
-                // use depht data in general
-                Scalar m = mean(depth_mat(object));
-
-                std::ostringstream ss;
-                ss << classNames[objectClass] << " ";
-                ss << std::setprecision(2) << m[0] << " meters away";
-                String conf(ss.str());
-
-                rectangle(color_mat, object, Scalar(0, 255, 0));
-                int baseLine = 0;
-                Size labelSize = getTextSize(ss.str(), FONT_HERSHEY_SIMPLEX, 0.5, 1, &baseLine);
-
-                auto center = (object.br() + object.tl())*0.5;
-                center.x = center.x - labelSize.width / 2;
-
-                rectangle(color_mat, Rect(Point(center.x, center.y - labelSize.height),
-                    Size(labelSize.width, labelSize.height + baseLine)),
-                    Scalar(255, 255, 255), CV_FILLED);
-                putText(color_mat, ss.str(), center,
-                        FONT_HERSHEY_SIMPLEX, 0.5, Scalar(0,0,0));
+                float confidence = detectionMat.at<float>(i, 2);
+
+                if(confidence > confidenceThreshold)
+                {
+                    size_t objectClass = (size_t)(detectionMat.at<float>(i, 1));
+
+                    int xLeftBottom = static_cast<int>(detectionMat.at<float>(i, 3) * color_mat.cols);
+                    int yLeftBottom = static_cast<int>(detectionMat.at<float>(i, 4) * color_mat.rows);
+                    int xRightTop = static_cast<int>(detectionMat.at<float>(i, 5) * color_mat.cols);
+                    int yRightTop = static_cast<int>(detectionMat.at<float>(i, 6) * color_mat.rows);
+
+                    Rect object((int)xLeftBottom, (int)yLeftBottom,
+                                (int)(xRightTop - xLeftBottom),
+                                (int)(yRightTop - yLeftBottom));
+
+                    object = object  & Rect(0, 0, color_mat.cols, color_mat.rows);
+
+                    // Calculate mean depth inside the detection region
+                    // This is a very naive way to estimate objects depth
+                    // but it is intended to demonstrate how one might 
+                    // use depht data in general
+                    // (detections are in the coordinates of the uncropped color frame)
+                    auto depth = aligner.process(depth_frame, profile, object + crop.tl());
+
+                    std::ostringstream ss;
+                    ss << classNames[objectClass] << " ";
+                    ss << std::setprecision(2) << depth.mean << " meters away";
+                    String conf(ss.str());
+
+                    rectangle(color_mat, object, Scalar(0, 255, 0));
+                    int baseLine = 0;
+                    Size labelSize = getTextSize(ss.str(), FONT_HERSHEY_SIMPLEX, 0.5, 1, &baseLine);
+
+                    auto center = (object.br() + object.tl())*0.5;
+                    center.x = center.x - labelSize.width / 2;
+
+                    rectangle(color_mat, Rect(Point(center.x, center.y - labelSize.height),
+                        Size(labelSize.width, labelSize.height + baseLine)),
+                        Scalar(255, 255, 255), CV_FILLED);
+                    putText(color_mat, ss.str(), center,
+                            FONT_HERSHEY_SIMPLEX, 0.5, Scalar(0,0,0));
+                }
             }
-        }
 
-        imshow(window_name, color_mat);
+            imshow(window_name, color_mat);
+        }
         if (waitKey(1) >= 0) break;
+
+        // Print how long each stage takes and how many items per second it completes
+        auto now = stage_stats::clock::now();
+        if (now - last_report > std::chrono::seconds(1))
+        {
+            std::cout << capture.stats().report() << std::endl
+                      << preprocess.stats().report() << std::endl
+                      << inference.stats().report() << std::endl
+                      << render.report() << std::endl
+                      << "preprocessed images skipped by inference: " << blobs.replaced() << std::endl
+                      << std::endl;
+            last_report = now;
+        }
     }
 
     return EXIT_SUCCESS;
@@ -9,61 +9,130 @@
 #include "../cv-helpers.hpp"    // Helper functions for conversions between RealSense and OpenCV
 #include "../../../src/concurrency.h" // We are borrowing from librealsense concurrency infrastructure for this sample
 #include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
 
 // Helper class to keep track of measured data
 // and generate basic statistics
-template<class T>
-class measurement
+// Samples are counted in a histogram with exact buckets for small values and 32 buckets per
+// power of two above that (HDR histogram layout), so percentiles are accurate to about 3%
+// without keeping the samples. Every counter is atomic: adding a sample never takes a lock,
+// and reading the statistics only scans the buckets.
+class histogram
 {
 public:
-    measurement(int cap = 10) : _capacity(cap), _sum() {}
-
-    // Media over rolling window
-    T median() const
+    histogram() : _total(0), _sum(0), _max(0), _below_zero(0)
     {
-        std::lock_guard<std::mutex> lock(_m);
+        for (auto& b : _buckets) b = 0;
+    }
 
-        if (_total == 0) return _sum;
+    // Add new measurement. Negative values are counted as 0
+    void add(int val)
+    {
+        if (val < 0)
+        {
+            _below_zero++;
+            val = 0;
+        }
+        _buckets[bucket_of(val)].fetch_add(1, std::memory_order_relaxed);
+        _sum.fetch_add(val, std::memory_order_relaxed);
+        auto max = _max.load(std::memory_order_relaxed);
+        while (val > max && !_max.compare_exchange_weak(max, val, std::memory_order_relaxed));
+        _total.fetch_add(1, std::memory_order_release);
+    }
 
-        std::vector<T> copy(begin(_data), end(_data));
-        std::sort(begin(copy), end(copy));
-        return copy[copy.size() / 2];
+    // Value below which the given fraction (0..1) of the samples falls
+    int percentile(double p) const
+    {
+        const long long total = _total.load(std::memory_order_acquire);
+        if (total == 0) return 0;
+        const long long rank = std::max(1LL, static_cast<long long>(std::ceil(p * total)));
+        long long seen = 0;
+        for (int i = 0; i < bucket_count; i++)
+        {
+            seen += _buckets[i].load(std::memory_order_relaxed);
+            if (seen >= rank) return std::min(highest_of(i), max());
+        }
+        return max();
     }
 
+    int median() const { return percentile(0.5); }
+    int max() const { return _max.load(std::memory_order_relaxed); }
+
     // Average over all samples
-    T avg() const
+    double avg() const
     {
-        std::lock_guard<std::mutex> lock(_m);
-        if (_total > 0) return _sum / _total;
-        return _sum;
+        auto total = _total.load(std::memory_order_acquire);
+        return total ? double(_sum.load(std::memory_order_relaxed)) / total : 0.;
     }
 
     // Total count of measurements
-    int total() const 
-    { 
-        std::lock_guard<std::mutex> lock(_m);
-        return _total; 
+    int total() const { return int(_total.load(std::memory_order_acquire)); }
+
+    // Summary and every non-empty bucket as a JSON object
+    void write_json(std::ostream& out) const
+    {
+        out << "{ \"total\": " << total() << ", \"below_zero\": " << _below_zero.load()
+            << ", \"avg\": " << avg() << ", \"p50\": " << percentile(0.5)
+            << ", \"p90\": " << percentile(0.9) << ", \"p99\": " << percentile(0.99)
+            << ", \"max\": " << max() << ", \"buckets\": [";
+        const char* separator = "";
+        for (int i = 0; i < bucket_count; i++)
+        {
+            if (auto count = _buckets[i].load())
+            {
+                out << separator << "{ \"from\": " << lowest_of(i) << ", \"to\": " << highest_of(i)
+                    << ", \"count\": " << count << " }";
+                separator = ", ";
+            }
+        }
+        out << "] }";
     }
 
-    // Add new measurement
-    void add(T val)
+    // Every non-empty bucket as a line of "name,from,to,count"
+    void write_csv(std::ostream& out, const std::string& name) const
     {
-        std::lock_guard<std::mutex> lock(_m);
-        _data.push_back(val);
-        if (_data.size() > _capacity)
+        for (int i = 0; i < bucket_count; i++)
         {
-            _data.pop_front();
+            if (auto count = _buckets[i].load())
+                out << name << "," << lowest_of(i) << "," << highest_of(i) << "," << count << "\n";
         }
-        _total++;
-        _sum += val;
     }
 
 private:
-    mutable std::mutex _m;
-    T _sum;
-    std::deque<T> _data;
-    int _capacity;
-    int _total = 0;
+    static const int sub_bits = 5;                  // 32 buckets per power of two
+    static const int sub_count = 1 << sub_bits;
+    static const int bucket_count = 2 * sub_count + (31 - sub_bits - 1) * sub_count;
+
+    // Values below 2 * sub_count have a bucket each
+    static int bucket_of(int val)
+    {
+        if (val < 2 * sub_count) return val;
+        int high_bit = 0;
+        while ((val >> high_bit) > 1) high_bit++;
+        const int shift = high_bit - sub_bits;
+        return 2 * sub_count + (shift - 1) * sub_count + ((val >> shift) - sub_count);
+    }
+    static int lowest_of(int bucket)
+    {
+        if (bucket < 2 * sub_count) return bucket;
+        const int shift = (bucket - 2 * sub_count) / sub_count + 1;
+        return ((bucket - 2 * sub_count) % sub_count + sub_count) << shift;
+    }
+    static int highest_of(int bucket)
+    {
+        if (bucket < 2 * sub_count) return bucket;
+        const int shift = (bucket - 2 * sub_count) / sub_count + 1;
+        return lowest_of(bucket) + ((1 << shift) - 1);
+    }
+
+    std::atomic<unsigned int> _buckets[bucket_count];
+    std::atomic<long long> _total;
+    std::atomic<long long> _sum;
+    std::atomic<int> _max;
+    std::atomic<int> _below_zero;
 };
 
 // Helper class to encode / decode numbers into
@@ -136,6 +205,69 @@ private:
     int _digits;
 };
 
+// The clock is rendered as a row of digits + 2 circles at the top of the image:
+// a marker circle at each end, and between them one circle per bit that is on
+inline int clock_circle_width(int image_w, int digits) { return (image_w - 120) / (digits + 2); }
+inline int clock_circle_radius(int image_w, int digits) { return clock_circle_width(image_w, digits) / 2 - 6; }
+inline cv::Point clock_circle_center(int i, int image_w, int digits)
+{
+    const int rad = clock_circle_radius(image_w, digits);
+    return cv::Point(50 + clock_circle_width(image_w, digits) * i + rad, 70 + rad);
+}
+
+// Render the clock value stored in the packer (see bit_packer::try_pack)
+inline void draw_clock(cv::Mat& image, bit_packer& packer, int digits, int line_type = 8)
+{
+    for (int i = 0; i < digits + 2; i++)
+    {
+        // Always render the corner two circles (as markers)
+        if (i == 0 || i == digits + 1 || packer.get()[i - 1])
+        {
+            cv::circle(image, clock_circle_center(i, image.cols, digits),
+                clock_circle_radius(image.cols, digits), cv::Scalar(255, 255, 255), -1, line_type);
+        }
+    }
+}
+
+// Find the circles of the clock in the top quarter of a (blurred) grayscale image
+inline std::vector<cv::Vec3f> find_clock_circles(const cv::Mat& gray)
+{
+    std::vector<cv::Vec3f> circles;
+    cv::Rect roi(cv::Point(0, 0), cv::Size(gray.cols, gray.rows / 4));
+    cv::HoughCircles(gray(roi), circles, cv::HOUGH_GRADIENT, 1, 10, 100, 30, 1, 100);
+    return circles;
+}
+
+// Try to decode the clock value from the circles found in the image
+// The bits are read from the positions of the circles between the two markers
+inline bool decode_clock_circles(std::vector<cv::Vec3f> circles, bit_packer& packer, int digits, int* value)
+{
+    sort(circles.begin(), circles.end(),
+        [](const cv::Vec3f& a, const cv::Vec3f& b) -> bool
+    {
+        return a[0] < b[0];
+    });
+    if (circles.size() <= 1) return false;
+
+    int min_x = circles[0][0];
+    int max_x = circles[circles.size() - 1][0];
+
+    int circle_est_size = (max_x - min_x) / (digits + 1);
+    min_x += circle_est_size / 2;
+    max_x -= circle_est_size / 2;
+
+    packer.reset();
+    for (int i = 1; i < circles.size() - 1; i++)
+    {
+        const int x = circles[i][0];
+        const int idx = digits * ((float)(x - min_x) / (max_x - min_x));
+        if (idx >= 0 && idx < packer.get().size())
+            packer.get()[idx] = true;
+    }
+
+    return packer.try_unpack(value);
+}
+
 // Main class in charge of detecting latency measurements
 class detector
 {
@@ -143,9 +275,9 @@ public:
     detector(int digits, int display_w) 
         : _digits(digits), _packer(digits), 
           _display_w(display_w),
-          _t([this]() { detect(); }),
           _preview_size(600, 350),
-          _next_value(0), _next(false), _alive(true)
+          _next_value(0), _next(false), _alive(true),
+          _t([this]() { detect(); })
     {
         using namespace cv;
 
@@ -173,6 +305,7 @@ public:
     {
         auto duration = std::chrono::high_resolution_clock::now() - _render_start;
         _render_time.add(std::chrono::duration_cast<std::chrono::milliseconds>(duration).count());
+        add_stage(render, std::chrono::duration<double, std::milli>(duration).count());
     }
 
     ~detector()
@@ -188,12 +321,19 @@ public:
 
         frame_for_processing.f = f;
 
+        rs2_error* e = nullptr;
+        frame_for_processing.submitted = rs2_get_time(&e);
+
         // Read how much time the frame spent from
         // being released by the OS-dependent driver (Windows Media Foundation, V4L2 or libuvc)
         // to this point in time (when it is first accessible to the application)
         auto toa = f.get_frame_metadata(RS2_FRAME_METADATA_TIME_OF_ARRIVAL);
-        rs2_error* e;
-        _processing_time.add(rs2_get_time(&e) - toa);
+        add_stage(arrival_to_callback, frame_for_processing.submitted - toa);
+
+        // Frame timestamps can only be compared with the host clock when they are in system time
+        // (otherwise they come from the device clock)
+        if (f.get_frame_timestamp_domain() == RS2_TIMESTAMP_DOMAIN_SYSTEM_TIME)
+            add_stage(sensor_to_arrival, toa - f.get_timestamp());
 
         auto duration = std::chrono::high_resolution_clock::now() - _start_time;
         auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(duration).count();
@@ -231,13 +371,82 @@ public:
         _instructions.copyTo(display(text_roi));
     }
 
+    // Print how long frames spend in each stage, from the sensor to the rendered clock
+    void report(std::ostream& out) const
+    {
+        out << std::left << std::setw(22) << "Stage" << std::right
+            << std::setw(10) << "p50 ms" << std::setw(10) << "p90 ms"
+            << std::setw(10) << "p99 ms" << std::setw(10) << "max ms" << std::setw(10) << "samples" << std::endl;
+        for (int i = 0; i < stage_count; i++)
+        {
+            auto& h = _stages[i];
+            out << std::left << std::setw(22) << stage_names()[i] << std::right << std::fixed << std::setprecision(2)
+                << std::setw(10) << h.percentile(0.5) / 1000. << std::setw(10) << h.percentile(0.9) / 1000.
+                << std::setw(10) << h.percentile(0.99) / 1000. << std::setw(10) << h.max() / 1000.
+                << std::setw(10) << h.total() << std::endl;
+        }
+        out << std::left << std::setw(22) << "Estimated latency" << std::right
+            << std::setw(10) << _latency.percentile(0.5) << std::setw(10) << _latency.percentile(0.9)
+            << std::setw(10) << _latency.percentile(0.99) << std::setw(10) << _latency.max()
+            << std::setw(10) << _latency.total() << std::endl;
+    }
+
+    // Write the full histograms of the measurements to <prefix>.json and <prefix>.csv,
+    // to compare runs across configurations / builds
+    // Names end with the unit of the histogram (the stages are measured in microseconds)
+    void save(const std::string& prefix) const
+    {
+        std::ofstream json(prefix + ".json");
+        json << "{\n  \"latency_ms\": ";
+        _latency.write_json(json);
+        json << ",\n  \"render_ms\": ";
+        _render_time.write_json(json);
+        for (int i = 0; i < stage_count; i++)
+        {
+            json << ",\n  \"" << stage_names()[i] << "_us\": ";
+            _stages[i].write_json(json);
+        }
+        json << "\n}\n";
+
+        std::ofstream csv(prefix + ".csv");
+        csv << "measurement,from,to,count\n";
+        _latency.write_csv(csv, "latency_ms");
+        _render_time.write_csv(csv, "render_ms");
+        for (int i = 0; i < stage_count; i++)
+            _stages[i].write_csv(csv, std::string(stage_names()[i]) + "_us");
+    }
+
 private:
     struct record
     {
         rs2::frame f;
-        long long ms;
+        long long ms;     // Clock value when the frame was submitted, compared with the decoded clock
+        double submitted; // rs2_get_time() when the frame was submitted
+    };
+
+    // Steps of the way of a frame, each measured from the end of the previous one
+    enum stage
+    {
+        sensor_to_arrival,      // Frame timestamp to time of arrival (system time domain only)
+        arrival_to_callback,    // Time of arrival to submit_frame
+        callback_to_dequeue,    // Waiting in the queue for the detector
+        dequeue_to_decoded,     // Detecting and decoding the circles
+        render,                 // Rendering the clock (not part of the path of the frame, but subtracted from the latency)
+        stage_count
     };
 
+    static const char** stage_names()
+    {
+        static const char* names[] = { "sensor_to_arrival", "arrival_to_callback",
+            "callback_to_dequeue", "dequeue_to_decoded", "render" };
+        return names;
+    }
+
+    void add_stage(stage s, double ms)
+    {
+        _stages[s].add(static_cast<int>(std::lround(ms * 1000)));
+    }
+
     void next()
     {
         record r;
@@ -274,15 +483,20 @@ private:
             0.8, Scalar(255, 255, 255), 2, LINE_AA);
 
         ss.str("");
-        ss << "Estimated Latency: (Rolling-Median)" << _latency.median() << "ms, ";
-        ss << "(Average)" << _latency.avg() << "ms";
+        ss << "Estimated Latency: (p50)" << _latency.percentile(0.5) << "ms, ";
+        ss << "(p90)" << _latency.percentile(0.9) << "ms, ";
+        ss << "(p99)" << _latency.percentile(0.99) << "ms, ";
+        ss << "(Max)" << _latency.max() << "ms";
 
         putText(_instructions, ss.str().c_str(),
             Point(80, 60), CV_FONT_HERSHEY_SIMPLEX,
             0.8, Scalar(255, 255, 255), 2, LINE_AA);
 
         ss.str("");
-        ss << "Software Processing: " << _processing_time.median() << "ms";
+        ss << std::fixed << std::setprecision(2) << "(p50) Arrival-to-App: "
+           << _stages[arrival_to_callback].median() / 1000. << "ms, ";
+        ss << "Queue: " << _stages[callback_to_dequeue].median() / 1000. << "ms, ";
+        ss << "Detection: " << _stages[dequeue_to_decoded].median() / 1000. << "ms";
 
         putText(_instructions, ss.str().c_str(),
             Point(80, 100), CV_FONT_HERSHEY_SIMPLEX,
@@ -296,23 +510,31 @@ private:
 
         while (_alive)
         {
-            std::this_thread::sleep_for(std::chrono::milliseconds(1));
             record r;
-            if (_queue.try_dequeue(&r))
+            // Wake up as soon as a frame is submitted
+            // The timeout only lets the thread notice when the detector is destroyed
+            if (_queue.dequeue(&r, 100))
             {
+                rs2_error* e = nullptr;
+                const double dequeued = rs2_get_time(&e);
+                add_stage(callback_to_dequeue, dequeued - r.submitted);
+
                 // Make sure we request new number,
                 // UNLESS we decide to keep waiting
                 detector_lock flush_queue_after(this);
 
-                auto color_mat = frame_to_mat(r.f);
-
-                if (color_mat.channels() > 1)
-                    cvtColor(color_mat, color_mat, COLOR_BGR2GRAY);
-                medianBlur(color_mat, color_mat, 5);
+                // frame_to_mat may return a view of the frame's own buffer,
+                // so results are written to a separate matrix
+                auto frame_mat = frame_to_mat(r.f);
+                Mat color_mat;
+                if (frame_mat.channels() > 1)
+                {
+                    cvtColor(frame_mat, color_mat, COLOR_BGR2GRAY);
+                    medianBlur(color_mat, color_mat, 5);
+                }
+                else medianBlur(frame_mat, color_mat, 5);
 
-                std::vector<Vec3f> circles;
-                cv::Rect roi(Point(0, 0), Size(color_mat.size().width, color_mat.size().height / 4));
-                HoughCircles(color_mat(roi), circles, HOUGH_GRADIENT, 1, 10, 100, 30, 1, 100);
+                auto circles = find_clock_circles(color_mat);
                 for (size_t i = 0; i < circles.size(); i++)
                 {
                     Vec3i c = circles[i];
@@ -326,50 +548,28 @@ private:
                     _last_preview = color_mat;
                 }
 
-                sort(circles.begin(), circles.end(),
-                    [](const Vec3f& a, const Vec3f& b) -> bool
-                {
-                    return a[0] < b[0];
-                });
-                if (circles.size() > 1)
+                int res;
+                if (decode_clock_circles(circles, _packer, _digits, &res))
                 {
-                    int min_x = circles[0][0];
-                    int max_x = circles[circles.size() - 1][0];
-
-                    int circle_est_size = (max_x - min_x) / (_digits + 1);
-                    min_x += circle_est_size / 2;
-                    max_x -= circle_est_size / 2;
-
-                    _packer.reset();
-                    for (int i = 1; i < circles.size() - 1; i++)
-                    {
-                        const int x = circles[i][0];
-                        const int idx = _digits * ((float)(x - min_x) / (max_x - min_x));
-                        if (idx >= 0 && idx < _packer.get().size())
-                            _packer.get()[idx] = true;
-                    }
-
-                    int res;
-                    if (_packer.try_unpack(&res))
+                    if (res == _next_value)
                     {
-                        if (res == _next_value)
+                        auto cropped = r.ms % (1 << (_digits - 2));
+                        if (cropped > res)
                         {
-                            auto cropped = r.ms % (1 << (_digits - 2));
-                            if (cropped > res)
-                            {
-                                auto avg_render_time = _render_time.avg();
-                                _latency.add((cropped - res) - avg_render_time);
-                                update_instructions();
-                            }
-                        }
-                        else
-                        {
-                            // Only in case we detected valid number other then expected
-                            // We continue processing (since this was most likely older valid frame)
-                            flush_queue_after.abort();
+                            auto avg_render_time = _render_time.avg();
+                            _latency.add(static_cast<int>(std::lround((cropped - res) - avg_render_time)));
+                            update_instructions();
                         }
                     }
+                    else
+                    {
+                        // Only in case we detected valid number other then expected
+                        // We continue processing (since this was most likely older valid frame)
+                        flush_queue_after.abort();
+                    }
                 }
+
+                add_stage(dequeue_to_decoded, rs2_get_time(&e) - dequeued);
             }
         }
     }
@@ -379,7 +579,6 @@ private:
 
     std::atomic_bool _alive;
     bit_packer _packer;
-    std::thread _t;
     single_consumer_queue<record> _queue;
     std::chrono::high_resolution_clock::time_point _start_time;
     std::chrono::high_resolution_clock::time_point _render_start;
@@ -392,9 +591,12 @@ private:
     cv::Mat _last_preview;
     cv::Mat _instructions;
 
-    measurement<int> _render_time;
-    measurement<int> _processing_time;
-    measurement<int> _latency;
+    histogram _render_time;
+    histogram _latency;
+    histogram _stages[stage_count];
+
+    // Started last, once everything the detector thread uses is constructed
+    std::thread _t;
 };
 
 
@@ -0,0 +1,237 @@
+// License: Apache 2.0. See LICENSE file in root directory.
+// Copyright(c) 2018 Intel Corporation. All Rights Reserved.
+
+#pragma once
+
+#include "latency-detector.h"
+#include <librealsense2/hpp/rs_internal.hpp> // Software device
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+// Headless variant of the latency measurement, for runs without a camera or a display.
+// Instead of filming the screen, the clock pattern is drawn into synthetic color frames that are injected
+// through rs2::software_device, passed through a chain of processing blocks and decoded again.
+// This measures the latency added by librealsense and the processing chain, not the camera.
+
+struct loopback_options
+{
+    loopback_options() : width(1280), height(720), frames(300), fps(0), pixel_probe(false) {}
+
+    int width, height;              // Resolution of the synthetic frames
+    int frames;                     // Number of frames to inject
+    int fps;                        // Injection rate, 0 to inject the next frame as soon as the previous one was decoded
+    std::vector<std::string> chain; // Processing blocks applied in order: align, decimation, spatial, temporal, colorizer
+    bool pixel_probe;               // Decode by reading the known circle positions instead of searching for circles
+    std::string output;             // JSON report file, standard output when empty
+
+    // --frames N --size WxH --fps N --chain align,spatial,... --probe hough|pixel --output file
+    static loopback_options parse(int argc, char* argv[], int first)
+    {
+        loopback_options opt;
+        for (int i = first; i < argc; i++)
+        {
+            std::string arg = argv[i];
+            if (i + 1 >= argc) throw std::invalid_argument("Missing value for " + arg);
+            std::string value = argv[++i];
+
+            if (arg == "--frames") opt.frames = std::stoi(value);
+            else if (arg == "--fps") opt.fps = std::stoi(value);
+            else if (arg == "--size")
+            {
+                auto x = value.find('x');
+                if (x == std::string::npos) throw std::invalid_argument("--size expects WIDTHxHEIGHT");
+                opt.width = std::stoi(value.substr(0, x));
+                opt.height = std::stoi(value.substr(x + 1));
+            }
+            else if (arg == "--chain")
+            {
+                std::stringstream ss(value);
+                std::string block;
+                while (std::getline(ss, block, ',')) opt.chain.push_back(block);
+            }
+            else if (arg == "--probe")
+            {
+                if (value != "hough" && value != "pixel") throw std::invalid_argument("--probe expects hough or pixel");
+                opt.pixel_probe = value == "pixel";
+            }
+            else if (arg == "--output") opt.output = value;
+            else throw std::invalid_argument("Unknown argument " + arg);
+        }
+        return opt;
+    }
+};
+
+// Read the clock from a frame with the exact layout draw_clock produces,
+// by checking the center of every bit circle
+inline bool probe_clock(const cv::Mat& gray, bit_packer& packer, int digits, int* value)
+{
+    packer.reset();
+    for (int i = 1; i <= digits; i++)
+    {
+        auto center = clock_circle_center(i, gray.cols, digits);
+        packer.get()[i - 1] = gray.at<uint8_t>(center) > 127;
+    }
+    return packer.try_unpack(value);
+}
+
+inline void run_loopback_benchmark(const loopback_options& opt)
+{
+    using namespace cv;
+    using namespace rs2;
+    typedef std::chrono::high_resolution_clock clock;
+
+    const int digits = 16;
+    const int values = 1 << (digits - 2);
+
+    // Flat depth at 1 meter. Declared before the device, so it outlives the frames referring to it
+    std::vector<uint16_t> depth_pixels(opt.width * opt.height, 1000);
+
+    // Processing blocks that can be part of the chain
+    align align_to(RS2_STREAM_COLOR);
+    decimation_filter dec_filter;
+    spatial_filter spat_filter;
+    temporal_filter temp_filter;
+    colorizer color_map;
+    for (size_t i = 0; i < opt.chain.size(); i++)
+    {
+        auto& block = opt.chain[i];
+        if (block != "align" && block != "decimation" && block != "spatial" &&
+            block != "temporal" && block != "colorizer")
+            throw std::invalid_argument("Unknown processing block " + block);
+        if (block == "colorizer" && i + 1 != opt.chain.size())
+            throw std::invalid_argument("colorizer must be the last processing block");
+    }
+
+    // Software device with a color and a depth sensor, like a depth camera
+    software_device dev;
+    auto depth_sensor = dev.add_sensor("Depth");
+    auto color_sensor = dev.add_sensor("Color");
+
+    rs2_intrinsics intrinsics = { opt.width, opt.height,
+        opt.width / 2.f, opt.height / 2.f, float(opt.width), float(opt.width),
+        RS2_DISTORTION_BROWN_CONRADY, { 0, 0, 0, 0, 0 } };
+
+    auto depth_stream = depth_sensor.add_video_stream({ RS2_STREAM_DEPTH, 0, 0,
+        opt.width, opt.height, 30, 2, RS2_FORMAT_Z16, intrinsics });
+    depth_sensor.add_read_only_option(RS2_OPTION_DEPTH_UNITS, 0.001f);
+    auto color_stream = color_sensor.add_video_stream({ RS2_STREAM_COLOR, 0, 1,
+        opt.width, opt.height, 30, 3, RS2_FORMAT_BGR8, intrinsics });
+
+    dev.create_matcher(RS2_MATCHER_DLR_C);
+    syncer sync;
+
+    depth_sensor.open(depth_stream);
+    color_sensor.open(color_stream);
+    depth_sensor.start(sync);
+    color_sensor.start(sync);
+
+    depth_stream.register_extrinsics_to(color_stream, { { 1,0,0,0,1,0,0,0,1 },{ 0,0,0 } });
+
+    histogram latency; // microseconds
+    bit_packer packer(digits);
+    int decoded = 0, failed = 0, missing_color = 0;
+
+    const auto start = clock::now();
+    for (int n = 0; n < opt.frames; n++)
+    {
+        if (opt.fps > 0)
+            std::this_thread::sleep_until(start + n * std::chrono::microseconds(1000000 / opt.fps));
+
+        // Draw the clock into a new frame, owned by librealsense from now on
+        const int value = n % values;
+        auto pixels = new uint8_t[opt.width * opt.height * 3];
+        Mat image(opt.height, opt.width, CV_8UC3, pixels);
+        image = Scalar::all(0);
+        packer.try_pack(value);
+        // Anti-aliased, the circle detector doesn't find the perfectly sharp circles otherwise
+        draw_clock(image, packer, digits, LINE_AA);
+
+        const auto injected = clock::now();
+        const rs2_time_t timestamp = n * 1000. / 30;
+        depth_sensor.on_video_frame({ depth_pixels.data(), [](void*) {},
+            opt.width * 2, 2, timestamp, RS2_TIMESTAMP_DOMAIN_HARDWARE_CLOCK, n, depth_stream });
+        color_sensor.on_video_frame({ pixels, [](void* p) { delete[] static_cast<uint8_t*>(p); },
+            opt.width * 3, 3, timestamp, RS2_TIMESTAMP_DOMAIN_HARDWARE_CLOCK, n, color_stream });
+
+        // The matcher can release sets without color (eg depth alone for the first frames), and the color
+        // frame of an earlier injection may still arrive late. Wait for the color frame of this injection,
+        // skipping anything older, so that the decoded value stays in step with what was drawn
+        frameset data;
+        frame color;
+        while (sync.try_wait_for_frames(&data, 1000))
+        {
+            color = data.first_or_default(RS2_STREAM_COLOR);
+            if (color && color.get_frame_number() >= static_cast<unsigned long long>(n)) break;
+            color = frame();
+        }
+        if (!color || color.get_frame_number() != static_cast<unsigned long long>(n))
+        {
+            missing_color++;
+            failed++;
+            continue;
+        }
+
+        // Processing chain. Depth results are kept until the frame is decoded, like an application would
+        frame depth = data.first_or_default(RS2_STREAM_DEPTH);
+        for (auto&& block : opt.chain)
+        {
+            if (!depth) break;
+            if (block == "align")
+            {
+                data = align_to.process(data);
+                depth = data.get_depth_frame();
+                color = data.first_or_default(RS2_STREAM_COLOR);
+            }
+            else if (block == "decimation") depth = dec_filter.process(depth);
+            else if (block == "spatial") depth = spat_filter.process(depth);
+            else if (block == "temporal") depth = temp_filter.process(depth);
+            else if (block == "colorizer") depth = color_map.colorize(depth);
+        }
+
+        // Decode the clock from the color frame
+        Mat gray;
+        cvtColor(frame_to_mat(color), gray, COLOR_BGR2GRAY);
+        int res;
+        bool ok;
+        if (opt.pixel_probe) ok = probe_clock(gray, packer, digits, &res);
+        else
+        {
+            medianBlur(gray, gray, 5);
+            ok = decode_clock_circles(find_clock_circles(gray), packer, digits, &res);
+        }
+
+        if (ok && res == value)
+        {
+            auto duration = clock::now() - injected;
+            latency.add(static_cast<int>(std::chrono::duration_cast<std::chrono::microseconds>(duration).count()));
+            decoded++;
+        }
+        else failed++;
+    }
+    const double elapsed = std::chrono::duration<double>(clock::now() - start).count();
+
+    color_sensor.stop();
+    depth_sensor.stop();
+    color_sensor.close();
+    depth_sensor.close();
+
+    std::ofstream file;
+    if (!opt.output.empty()) file.open(opt.output);
+    std::ostream& out = opt.output.empty() ? std::cout : file;
+
+    out << "{\n  \"size\": \"" << opt.width << "x" << opt.height << "\",\n  \"chain\": [";
+    for (size_t i = 0; i < opt.chain.size(); i++)
+        out << (i ? ", " : "") << "\"" << opt.chain[i] << "\"";
+    out << "],\n  \"probe\": \"" << (opt.pixel_probe ? "pixel" : "hough") << "\",\n"
+        << "  \"fps\": " << opt.fps << ",\n"
+        << "  \"frames\": " << opt.frames << ",\n"
+        << "  \"decoded\": " << decoded << ",\n"
+        << "  \"failed\": " << failed << ",\n"
+        << "  \"missing_color\": " << missing_color << ",\n"
+        << "  \"elapsed_s\": " << elapsed << ",\n"
+        << "  \"throughput_fps\": " << (elapsed > 0 ? decoded / elapsed : 0.) << ",\n"
+        << "  \"latency_us\": ";
+    latency.write_json(out);
+    out << "\n}\n";
+}
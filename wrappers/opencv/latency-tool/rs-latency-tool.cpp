@@ -2,6 +2,7 @@
 // Copyright(c) 2017 Intel Corporation. All Rights Reserved.
 
 #include "latency-detector.h"
+#include "loopback-benchmark.h"
 
 // This demo is presenting one way to estimate latency without access to special equipment
 // See ReadMe.md for more information
@@ -10,6 +11,13 @@ int main(int argc, char * argv[]) try
     using namespace cv;
     using namespace rs2;
 
+    // Headless benchmark through a software device, see loopback-benchmark.h
+    if (argc > 1 && std::string(argv[1]) == "--headless")
+    {
+        run_loopback_benchmark(loopback_options::parse(argc, argv, 2));
+        return EXIT_SUCCESS;
+    }
+
     // Start RealSense camera
     // Uncomment the configuration you wish to test
     pipeline pipe;
@@ -48,7 +56,6 @@ int main(int argc, char * argv[]) try
 
     const int display_w = 1280;
     const int digits = 16;
-    const int circle_w = (display_w - 120) / (digits + 2);
     const int display_h = 720;
 
     bit_packer packer(digits);
@@ -86,16 +93,7 @@ int main(int argc, char * argv[]) try
         packer.try_pack(next_value);
 
         // Render the clock encoded in circles
-        for (int i = 0; i < digits + 2; i++)
-        {
-            const int rad = circle_w / 2 - 6;
-            // Always render the corner two circles (as markers)
-            if (i == 0 || i == digits + 1 || packer.get()[i - 1])
-            {
-                circle(display, Point(50 + circle_w * i + rad, 70 + rad),
-                    rad, Scalar(255, 255, 255), -1, 8);
-            }
-        }
+        draw_clock(display, packer, digits);
 
         // Display current frame. WaitKey is doing the actual rendering
         imshow(window_name, display);
@@ -105,6 +103,12 @@ int main(int argc, char * argv[]) try
         d.end_render();
     }
 
+    // Print the latency breakdown and save the collected measurements, the file name prefix can be passed as the first argument
+    const std::string report = argc > 1 ? argv[1] : "latency";
+    d.report(std::cout);
+    d.save(report);
+    std::cout << "Measurements saved to " << report << ".json and " << report << ".csv" << std::endl;
+
     return EXIT_SUCCESS;
 }
 catch (const rs2::error & e)
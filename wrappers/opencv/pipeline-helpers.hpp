@@ -0,0 +1,195 @@
+// License: Apache 2.0. See LICENSE file in root directory.
+// Copyright(c) 2018 Intel Corporation. All Rights Reserved.
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <iomanip>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+
+// Helpers for splitting a frame processing loop into stages that run on separate threads,
+// so that a slow stage (eg a neural network) doesn't hold back the camera or the display.
+// Stages pass frames to each other through rs2::frame_queue of capacity 1, which drops the
+// waiting frame when a new one arrives. Results that aren't frames go through latest<T>,
+// which behaves the same way. Either way a slow stage always works on the newest data
+// and never builds up a backlog.
+
+// Holds the most recent item one stage produced for the next
+template<class T>
+class latest
+{
+public:
+    latest() : _item(), _waiting(false), _published(false), _replaced(0) {}
+
+    // Replaces the item waiting to be taken, if there is one
+    void publish(T item)
+    {
+        {
+            std::lock_guard<std::mutex> lock(_m);
+            if (_waiting) _replaced++;
+            _item = std::move(item);
+            _waiting = true;
+            _published = true;
+        }
+        _cv.notify_one();
+    }
+
+    // Takes the waiting item, waiting up to timeout for one to be published
+    template<class Rep, class Period>
+    bool take(T& item, const std::chrono::duration<Rep, Period>& timeout)
+    {
+        std::unique_lock<std::mutex> lock(_m);
+        if (!_cv.wait_for(lock, timeout, [this]() { return _waiting; })) return false;
+        item = _item;
+        _waiting = false;
+        return true;
+    }
+
+    // Copies the last published item, whether it was taken or not.
+    // False if nothing was published yet
+    bool peek(T& item) const
+    {
+        std::lock_guard<std::mutex> lock(_m);
+        if (!_published) return false;
+        item = _item;
+        return true;
+    }
+
+    // How many items were replaced before anyone took them
+    int replaced() const
+    {
+        std::lock_guard<std::mutex> lock(_m);
+        return _replaced;
+    }
+
+private:
+    mutable std::mutex _m;
+    std::condition_variable _cv;
+    T _item;
+    bool _waiting, _published;
+    int _replaced;
+};
+
+// Helper class to measure how long a stage takes to process an item (latency)
+// and how many items it completes per second (throughput)
+class stage_stats
+{
+public:
+    typedef std::chrono::high_resolution_clock clock;
+
+    stage_stats(const std::string& name)
+        : _name(name), _count(0), _timed(0), _busy(0), _max(0), _since(clock::now()) {}
+
+    // Measures from its creation to its destruction
+    class timer
+    {
+    public:
+        timer(stage_stats& owner) : _owner(&owner), _start(clock::now()) {}
+        timer(timer&& other) : _owner(other._owner), _start(other._start) { other._owner = nullptr; }
+        ~timer() { if (_owner) _owner->add(clock::now() - _start); }
+    private:
+        stage_stats* _owner;
+        clock::time_point _start;
+    };
+
+    timer time() { return timer(*this); }
+
+    void add(clock::duration d)
+    {
+        std::lock_guard<std::mutex> lock(_m);
+        _count++;
+        _timed++;
+        _busy += d;
+        _max = std::max(_max, d);
+    }
+
+    // Counts an item without timing it, for stages that only pass items on
+    void add()
+    {
+        std::lock_guard<std::mutex> lock(_m);
+        _count++;
+    }
+
+    // One line with the statistics since the last report, and starts a new period
+    std::string report()
+    {
+        std::lock_guard<std::mutex> lock(_m);
+        auto now = clock::now();
+        auto elapsed = std::chrono::duration<double>(now - _since).count();
+        auto to_ms = [](clock::duration d) { return std::chrono::duration<double, std::milli>(d).count(); };
+
+        std::ostringstream ss;
+        ss << std::left << std::setw(12) << _name << std::right << std::fixed << std::setprecision(1)
+           << std::setw(7) << (elapsed > 0 ? _count / elapsed : 0.) << " per second";
+        if (_timed)
+            ss << ", latency " << std::setw(6) << to_ms(_busy) / _timed << " ms average, "
+               << std::setw(6) << to_ms(_max) << " ms max";
+
+        _count = _timed = 0;
+        _busy = _max = clock::duration(0);
+        _since = now;
+        return ss.str();
+    }
+
+private:
+    std::mutex _m;
+    std::string _name;
+    int _count, _timed;
+    clock::duration _busy, _max;
+    clock::time_point _since;
+};
+
+// A stage running on its own thread. work is called over and over until the stage is destroyed,
+// and is expected to return shortly when there is no input (wait with a timeout) so that the
+// stage can stop. It times the part that actually processes an item with stats.time().
+// An exception thrown by work stops the stage, and is rethrown by check() on the thread calling it
+class stage
+{
+public:
+    stage(const std::string& name, std::function<void(stage_stats&)> work)
+        : _stats(name), _alive(true),
+          _t([this, work]()
+          {
+              try
+              {
+                  while (_alive) work(_stats);
+              }
+              catch (...)
+              {
+                  std::lock_guard<std::mutex> lock(_m);
+                  _error = std::current_exception();
+              }
+          })
+    {
+    }
+
+    ~stage()
+    {
+        _alive = false;
+        _t.join();
+    }
+
+    stage_stats& stats() { return _stats; }
+
+    // Rethrows the exception that stopped the stage, if any
+    void check()
+    {
+        std::lock_guard<std::mutex> lock(_m);
+        if (_error) std::rethrow_exception(_error);
+    }
+
+private:
+    stage_stats _stats;
+    std::mutex _m;
+    std::exception_ptr _error;
+    std::atomic<bool> _alive;
+    std::thread _t;
+};
@@ -0,0 +1,316 @@
+// License: Apache 2.0. See LICENSE file in root directory.
+// Copyright(c) 2018 Intel Corporation. All Rights Reserved.
+
+#pragma once
+
+#include <librealsense2/rs.hpp> // Include RealSense Cross Platform API
+#include <librealsense2/rsutil.h>
+#include <pcl/point_types.h>    // Include PCL point types
+#include <pcl/point_cloud.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include <limits>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+#if defined(_M_X64) || defined(__SSE2__)
+#include <emmintrin.h>
+#define RS2_PCL_SSE2
+#endif
+
+// Conversions from rs2::points to pcl::PointCloud.
+// Organized clouds keep the layout of the depth image (width x height) and mark pixels without
+// depth with NaN coordinates, which is what PCL algorithms expect. Unorganized clouds only contain
+// the points that have depth. Rows are split between threads, and the coordinates of every point
+// are written with a single 16 byte store of x, y, z, 1 (the aligned layout of PCL points).
+
+namespace rs_pcl_detail
+{
+    // Number of bands the rows are split into, one per hardware thread
+    inline int row_bands(int rows)
+    {
+        const int threads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+        return std::max(1, std::min(threads, rows / 32));
+    }
+
+    // Runs f(band, first_row, last_row) for every band, in parallel.
+    // The bands only depend on the number of rows, so passes over the same image see the same bands
+    template<class F>
+    void for_each_band(int rows, F f)
+    {
+        const int bands = row_bands(rows);
+        std::vector<std::thread> threads;
+        for (int b = 1; b < bands; b++)
+            threads.emplace_back([&f, b, bands, rows]() { f(b, rows * b / bands, rows * (b + 1) / bands); });
+        f(0, 0, rows / bands);
+        for (auto& t : threads) t.join();
+    }
+
+    // Writes x, y, z, 1 from a vertex into a 16 byte aligned point, NaN coordinates if it has no depth.
+    // The vectorized load reads 4 floats, can_overread tells whether the float after the vertex exists
+    inline void store_xyz(float* dst, const float* src, bool can_overread)
+    {
+#ifdef RS2_PCL_SSE2
+        if (can_overread)
+        {
+            const __m128 xyz_mask = _mm_castsi128_ps(_mm_set_epi32(0, -1, -1, -1));
+            const __m128 one = _mm_set_ps(1.f, 0.f, 0.f, 0.f);
+            const __m128 nan = _mm_set1_ps(std::numeric_limits<float>::quiet_NaN());
+
+            const __m128 p = _mm_or_ps(_mm_and_ps(_mm_loadu_ps(src), xyz_mask), one);
+            __m128 invalid = _mm_cmpeq_ps(p, _mm_setzero_ps());
+            invalid = _mm_and_ps(_mm_shuffle_ps(invalid, invalid, _MM_SHUFFLE(2, 2, 2, 2)), xyz_mask);
+            _mm_store_ps(dst, _mm_or_ps(_mm_andnot_ps(invalid, p), _mm_and_ps(invalid, nan)));
+            return;
+        }
+#endif
+        if (src[2] == 0)
+            dst[0] = dst[1] = dst[2] = std::numeric_limits<float>::quiet_NaN();
+        else
+        {
+            dst[0] = src[0];
+            dst[1] = src[1];
+            dst[2] = src[2];
+        }
+        dst[3] = 1.f;
+    }
+
+    // Colors points from the pixel of the color frame their texture coordinates map to.
+    // Points that map outside of the color frame are black
+    class texture_sampler
+    {
+    public:
+        texture_sampler(const rs2::points& points, const rs2::video_frame& color)
+            : _tex(points.get_texture_coordinates()),
+              _data(static_cast<const uint8_t*>(color.get_data())),
+              _w(color.get_width()), _h(color.get_height()), _stride(color.get_stride_in_bytes())
+        {
+            switch (color.get_profile().format())
+            {
+            case RS2_FORMAT_RGB8:  _bpp = 3; _r = 0; _g = 1; _b = 2; break;
+            case RS2_FORMAT_BGR8:  _bpp = 3; _r = 2; _g = 1; _b = 0; break;
+            case RS2_FORMAT_RGBA8: _bpp = 4; _r = 0; _g = 1; _b = 2; break;
+            case RS2_FORMAT_BGRA8: _bpp = 4; _r = 2; _g = 1; _b = 0; break;
+            default: throw std::runtime_error("Only RGB8, BGR8, RGBA8 and BGRA8 color frames can be mapped to points");
+            }
+        }
+
+        void operator()(size_t i, pcl::PointXYZRGB& p) const
+        {
+            const int x = static_cast<int>(_tex[i].u * _w + 0.5f);
+            const int y = static_cast<int>(_tex[i].v * _h + 0.5f);
+            if (x < 0 || y < 0 || x >= _w || y >= _h)
+            {
+                p.r = p.g = p.b = 0;
+            }
+            else
+            {
+                auto pixel = _data + y * _stride + x * _bpp;
+                p.r = pixel[_r];
+                p.g = pixel[_g];
+                p.b = pixel[_b];
+            }
+            p.a = 255;
+        }
+
+    private:
+        const rs2::texture_coordinate* _tex;
+        const uint8_t* _data;
+        int _w, _h, _stride, _bpp, _r, _g, _b;
+    };
+
+    template<class PointT, class Color>
+    typename pcl::PointCloud<PointT>::Ptr convert(const rs2::points& points, bool organized, const Color& color)
+    {
+        typename pcl::PointCloud<PointT>::Ptr cloud(new pcl::PointCloud<PointT>);
+
+        auto sp = points.get_profile().as<rs2::video_stream_profile>();
+        const int w = sp.width(), h = sp.height();
+        const size_t n = points.size();
+        if (n != size_t(w) * h) throw std::runtime_error("Points don't match the resolution of their stream");
+
+        const float* vertices = reinterpret_cast<const float*>(points.get_vertices());
+        auto copy = [vertices, n, &color](size_t i, PointT& p)
+        {
+            store_xyz(p.data, vertices + 3 * i, i + 1 < n);
+            color(i, p);
+        };
+
+        if (organized)
+        {
+            cloud->width = w;
+            cloud->height = h;
+            cloud->is_dense = false;
+            cloud->points.resize(n);
+            PointT* out = cloud->points.data();
+            for_each_band(h, [&](int, int first, int last)
+            {
+                for (size_t i = size_t(first) * w; i < size_t(last) * w; i++)
+                    copy(i, out[i]);
+            });
+        }
+        else
+        {
+            // Count the points with depth in every band, then each band writes from its offset
+            std::vector<size_t> offsets(row_bands(h) + 1, 0);
+            for_each_band(h, [&](int band, int first, int last)
+            {
+                size_t count = 0;
+                for (size_t i = size_t(first) * w; i < size_t(last) * w; i++)
+                    count += vertices[3 * i + 2] != 0;
+                offsets[band + 1] = count;
+            });
+            std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+
+            cloud->points.resize(offsets.back());
+            PointT* out = cloud->points.data();
+            for_each_band(h, [&](int band, int first, int last)
+            {
+                PointT* p = out + offsets[band];
+                for (size_t i = size_t(first) * w; i < size_t(last) * w; i++)
+                    if (vertices[3 * i + 2] != 0) copy(i, *p++);
+            });
+            cloud->width = static_cast<uint32_t>(offsets.back());
+            cloud->height = 1;
+            cloud->is_dense = true;
+        }
+        return cloud;
+    }
+}
+
+// Convert rs2::points to a cloud of pcl::PointXYZ
+pcl::PointCloud<pcl::PointXYZ>::Ptr points_to_pcl(const rs2::points& points, bool organized = true)
+{
+    return rs_pcl_detail::convert<pcl::PointXYZ>(points, organized, [](size_t, pcl::PointXYZ&) {});
+}
+
+// Convert rs2::points to a cloud of pcl::PointXYZRGB, colored from the frame the points were mapped to
+// (see rs2::pointcloud::map_to)
+pcl::PointCloud<pcl::PointXYZRGB>::Ptr points_to_pcl(const rs2::points& points, const rs2::video_frame& color, bool organized = true)
+{
+    rs_pcl_detail::texture_sampler sampler(points, color);
+    return rs_pcl_detail::convert<pcl::PointXYZRGB>(points, organized, sampler);
+}
+
+// Region of the depth image to convert, in pixels
+struct pixel_roi
+{
+    int x, y, width, height;
+};
+
+// Builds an unorganized cloud of only the depth pixels with z in [min_z, max_z] meters, optionally
+// inside a pixel region, straight from a Z16 depth frame. The z range is turned into bounds on the raw
+// depth values, so out of range pixels are skipped before they are deprojected, and the cloud is
+// allocated for the points that are kept. This replaces computing the whole point cloud and cropping
+// it with pcl::PassThrough on z.
+class depth_range_to_pcl
+{
+public:
+    depth_range_to_pcl(float min_z, float max_z)
+        : _min_z(min_z), _max_z(max_z), _profile_id(-1), _scale(0.f), _min_units(1), _max_units(0) {}
+
+    pcl::PointCloud<pcl::PointXYZ>::Ptr operator()(const rs2::depth_frame& depth)
+    {
+        return (*this)(depth, { 0, 0, depth.get_width(), depth.get_height() });
+    }
+
+    // Converts only the pixels inside roi, clipped to the frame
+    pcl::PointCloud<pcl::PointXYZ>::Ptr operator()(const rs2::depth_frame& depth, pixel_roi roi)
+    {
+        if (depth.get_profile().format() != RS2_FORMAT_Z16)
+            throw std::runtime_error("Only Z16 depth frames can be converted");
+        update(depth);
+
+        const int x0 = std::max(roi.x, 0), y0 = std::max(roi.y, 0);
+        const int x1 = std::min(roi.x + roi.width, depth.get_width());
+        const int y1 = std::min(roi.y + roi.height, depth.get_height());
+        const int rows = std::max(y1 - y0, 0);
+
+        auto data = static_cast<const uint8_t*>(depth.get_data());
+        const int stride = depth.get_stride_in_bytes();
+        const uint16_t lo = _min_units, hi = _max_units;
+
+        // Count the kept pixels of every band, then each band deprojects its pixels from its offset
+        std::vector<size_t> offsets(rs_pcl_detail::row_bands(rows) + 1, 0);
+        if (x1 > x0 && lo <= hi)
+        {
+            rs_pcl_detail::for_each_band(rows, [&](int band, int first, int last)
+            {
+                size_t count = 0;
+                for (int y = y0 + first; y < y0 + last; y++)
+                {
+                    auto row = reinterpret_cast<const uint16_t*>(data + y * stride);
+                    for (int x = x0; x < x1; x++)
+                        count += (row[x] >= lo) & (row[x] <= hi);
+                }
+                offsets[band + 1] = count;
+            });
+        }
+        std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+
+        pcl::PointCloud<pcl::PointXYZ>::Ptr cloud(new pcl::PointCloud<pcl::PointXYZ>);
+        cloud->points.resize(offsets.back());
+        cloud->width = static_cast<uint32_t>(offsets.back());
+        cloud->height = 1;
+        cloud->is_dense = true;
+        if (cloud->points.empty()) return cloud;
+
+        pcl::PointXYZ* out = cloud->points.data();
+        rs_pcl_detail::for_each_band(rows, [&](int band, int first, int last)
+        {
+            pcl::PointXYZ* p = out + offsets[band];
+            for (int y = y0 + first; y < y0 + last; y++)
+            {
+                auto row = reinterpret_cast<const uint16_t*>(data + y * stride);
+                for (int x = x0; x < x1; x++)
+                {
+                    if (row[x] < lo || row[x] > hi) continue;
+                    const float pixel[2] = { static_cast<float>(x), static_cast<float>(y) };
+                    rs2_deproject_pixel_to_point(p->data, &_intrin, pixel, row[x] * _scale);
+                    p++;
+                }
+            }
+        });
+        return cloud;
+    }
+
+private:
+    // Looks up the depth units and intrinsics when the stream profile changes, and converts
+    // the z range to the raw values whose z (raw * scale, as deprojected) falls inside it
+    void update(const rs2::depth_frame& depth)
+    {
+        auto profile = depth.get_profile();
+        if (profile.unique_id() == _profile_id) return;
+
+        rs2_error* e = nullptr;
+        auto sensor = rs2_get_frame_sensor(depth.get(), &e);
+        rs2::error::handle(e);
+        _scale = rs2_get_depth_scale(sensor, &e);
+        rs2_delete_sensor(sensor);
+        rs2::error::handle(e);
+        _intrin = profile.as<rs2::video_stream_profile>().get_intrinsics();
+
+        // Rounding makes z * scale slightly off from the exact bound, so step to the first value inside
+        const double max_units = std::numeric_limits<uint16_t>::max();
+        double lo = std::min(std::max(std::ceil(double(_min_z) / _scale), 1.), max_units + 1);
+        while (lo > 1 && static_cast<float>(lo - 1) * _scale >= _min_z) lo--;
+        while (lo <= max_units && static_cast<float>(lo) * _scale < _min_z) lo++;
+        double hi = std::min(std::max(std::floor(double(_max_z) / _scale), 0.), max_units);
+        while (hi < max_units && static_cast<float>(hi + 1) * _scale <= _max_z) hi++;
+        while (hi >= 1 && static_cast<float>(hi) * _scale > _max_z) hi--;
+
+        // An empty range is lo > hi
+        _min_units = static_cast<uint16_t>(std::min(lo, max_units));
+        _max_units = lo > max_units ? 0 : static_cast<uint16_t>(hi);
+        _profile_id = profile.unique_id();
+    }
+
+    float _min_z, _max_z;
+    int _profile_id;
+    float _scale;
+    rs2_intrinsics _intrin;
+    uint16_t _min_units, _max_units;
+};
@@ -3,43 +3,24 @@
 
 #include <librealsense2/rs.hpp> // Include RealSense Cross Platform API
 #include "../../../examples/example.hpp" // Include short list of convenience functions for rendering
+#include "../pcl-helpers.hpp"                // Include fast conversions from RealSense frames to PCL
 
 #include <pcl/point_types.h>
-#include <pcl/filters/passthrough.h>
+#include <cmath>
 
 // Struct for managing rotation of pointcloud view
 struct state {
     state() : yaw(0.0), pitch(0.0), last_x(0.0), last_y(0.0),
-        ml(false), offset_x(0.0f), offset_y(0.0f) {}
-    double yaw, pitch, last_x, last_y; bool ml; float offset_x, offset_y; 
+        ml(false), offset_x(0.0f), offset_y(0.0f), colored(false) {}
+    double yaw, pitch, last_x, last_y; bool ml; float offset_x, offset_y; bool colored;
 };
 
 using pcl_ptr = pcl::PointCloud<pcl::PointXYZ>::Ptr;
+using pcl_color_ptr = pcl::PointCloud<pcl::PointXYZRGB>::Ptr;
 
 // Helper functions
 void register_glfw_callbacks(window& app, state& app_state);
-void draw_pointcloud(window& app, state& app_state, const std::vector<pcl_ptr>& points);
-
-pcl_ptr points_to_pcl(const rs2::points& points)
-{
-    pcl_ptr cloud(new pcl::PointCloud<pcl::PointXYZ>);
-
-    auto sp = points.get_profile().as<rs2::video_stream_profile>();
-    cloud->width = sp.width();
-    cloud->height = sp.height();
-    cloud->is_dense = false;
-    cloud->points.resize(points.size());
-    auto ptr = points.get_vertices();
-    for (auto& p : cloud->points)
-    {
-        p.x = ptr->x;
-        p.y = ptr->y;
-        p.z = ptr->z;
-        ptr++;
-    }
-
-    return cloud;
-}
+void draw_pointcloud(window& app, state& app_state, const std::vector<pcl_ptr>& points, const pcl_color_ptr& colored);
 
 float3 colors[] { { 0.8f, 0.1f, 0.3f }, 
                   { 0.1f, 0.9f, 0.5f },
@@ -54,11 +35,6 @@ int main(int argc, char * argv[]) try
     // register callbacks to allow manipulation of the pointcloud
     register_glfw_callbacks(app, app_state);
 
-    // Declare pointcloud object, for calculating pointclouds and texture mappings
-    rs2::pointcloud pc;
-    // We want the points object to be persistent so we can display the last cloud when a frame drops
-    rs2::points points;
-
     // Declare RealSense pipeline, encapsulating the actual device and sensors
     rs2::pipeline pipe;
     // Start streaming with default recommended configuration
@@ -69,25 +45,29 @@ int main(int argc, char * argv[]) try
 
     auto depth = frames.get_depth_frame();
 
-    // Generate the pointcloud and texture mappings
-    points = pc.calculate(depth);
-
-    auto pcl_points = points_to_pcl(points);
-
-    pcl_ptr cloud_filtered(new pcl::PointCloud<pcl::PointXYZ>);
-    pcl::PassThrough<pcl::PointXYZ> pass;
-    pass.setInputCloud(pcl_points);
-    pass.setFilterFieldName("z");
-    pass.setFilterLimits(0.0, 1.0);
-    pass.filter(*cloud_filtered);
+    // Split the points at 1 meter. The z range is checked on the raw depth values, so each cloud
+    // only deprojects the pixels it keeps, instead of filtering a full cloud with pcl::PassThrough.
+    // Both ranges are inclusive, so the far one starts just above 1 meter
+    const float max_z = std::numeric_limits<float>::max();
+    depth_range_to_pcl near_range(0.f, 1.f);
+    depth_range_to_pcl far_range(std::nextafter(1.f, max_z), max_z);
 
     std::vector<pcl_ptr> layers;
-    layers.push_back(pcl_points);
-    layers.push_back(cloud_filtered);
+    layers.push_back(far_range(depth));
+    layers.push_back(near_range(depth));
+
+    // The whole scene as an organized cloud, colored from the color frame (press C to show it)
+    pcl_color_ptr colored;
+    if (auto color = frames.get_color_frame())
+    {
+        rs2::pointcloud pc;
+        pc.map_to(color);
+        colored = points_to_pcl(pc.calculate(depth), color);
+    }
 
     while (app) // Application still alive?
     {
-        draw_pointcloud(app, app_state, layers);
+        draw_pointcloud(app, app_state, layers, colored);
     }
 
     return EXIT_SUCCESS;
@@ -138,11 +118,15 @@ void register_glfw_callbacks(window& app, state& app_state)
         {
             app_state.yaw = app_state.pitch = 0; app_state.offset_x = app_state.offset_y = 0.0;
         }
+        if (key == 67) // C
+        {
+            app_state.colored = !app_state.colored;
+        }
     };
 }
 
 // Handles all the OpenGL calls needed to display the point cloud
-void draw_pointcloud(window& app, state& app_state, const std::vector<pcl_ptr>& points)
+void draw_pointcloud(window& app, state& app_state, const std::vector<pcl_ptr>& points, const pcl_color_ptr& colored)
 {
     // OpenGL commands that prep screen for the pointcloud
     glPopMatrix();
@@ -169,28 +153,45 @@ void draw_pointcloud(window& app, state& app_state, const std::vector<pcl_ptr>&
     glPointSize(width / 640);
     glEnable(GL_TEXTURE_2D);
 
-    int color = 0;
-
-    for (auto&& pc : points)
+    if (app_state.colored && colored)
     {
-        auto c = colors[(color++) % (sizeof(colors) / sizeof(float3))];
-
         glBegin(GL_POINTS);
-        glColor3f(c.x, c.y, c.z);
-
-        /* this segment actually prints the pointcloud */
-        for (int i = 0; i < pc->points.size(); i++)
+        // The cloud is organized, pixels without depth are NaN
+        for (auto&& p : colored->points)
         {
-            auto&& p = pc->points[i];
-            if (p.z)
+            if (p.z > 0) // false for NaN as well
             {
-                // upload the point and texture coordinates only for points we have depth data for
+                glColor3ub(p.r, p.g, p.b);
                 glVertex3f(p.x, p.y, p.z);
             }
         }
-
         glEnd();
     }
+    else
+    {
+        int color = 0;
+
+        for (auto&& pc : points)
+        {
+            auto c = colors[(color++) % (sizeof(colors) / sizeof(float3))];
+
+            glBegin(GL_POINTS);
+            glColor3f(c.x, c.y, c.z);
+
+            /* this segment actually prints the pointcloud */
+            for (int i = 0; i < pc->points.size(); i++)
+            {
+                auto&& p = pc->points[i];
+                if (p.z > 0) // false for NaN as well
+                {
+                    // upload the point and texture coordinates only for points we have depth data for
+                    glVertex3f(p.x, p.y, p.z);
+                }
+            }
+
+            glEnd();
+        }
+    }
 
     // OpenGL cleanup
     glPopMatrix();